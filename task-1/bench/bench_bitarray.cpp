@@ -0,0 +1,137 @@
+#include "../src/BitArray.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+
+// Замеры операций BitArray на массивах от 64 бит до 1 Гбит.
+// Для каждой операции печатается время одного вызова (ns/op) и, для
+// операций над всем массивом, скорость обработки его байтов (GB/s).
+//
+// Аргумент: наибольший размер в битах (по умолчанию 2^30)
+
+// Короткие операции повторяются, пока не наберётся это время
+static const double MIN_SECONDS = 0.1;
+
+// Побитовые операции (set, [], push_back) делаются не более чем столько раз за замер
+static const size_t MAX_BIT_OPS = size_t(1) << 24;
+
+static const size_t BLOCK_BITS = sizeof(unsigned long) * 8;
+
+// Не даёт компилятору выбросить результат
+static volatile size_t g_sink;
+
+// Время одного вызова operation в секундах
+static double measure(const std::function<void()>& operation) {
+    size_t runs = 0;
+    double total = 0;
+    while (runs == 0 || total < MIN_SECONDS) {
+        auto start = std::chrono::steady_clock::now();
+        operation();
+        total += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        runs++;
+    }
+    return total / runs;
+}
+
+// ops - число элементарных операций за вызов, bytes - обработанные байты (0 - не печатать)
+static void report(const char* name, size_t bits, double seconds, size_t ops, size_t bytes) {
+    std::printf("%-14s %12zu %14.3f", name, bits, seconds * 1e9 / ops);
+    if (bytes > 0) {
+        std::printf(" %10.3f", bytes / seconds / 1e9);
+    } else {
+        std::printf(" %10s", "-");
+    }
+    std::printf("\n");
+}
+
+// Псевдослучайный, но воспроизводимый массив
+static BitArray randomArray(size_t bits, unsigned long long seed) {
+    BitArray array(static_cast<int>(bits));
+    unsigned long* blocks = array.data();
+    size_t count = (bits + BLOCK_BITS - 1) / BLOCK_BITS;
+    for (size_t i = 0; i < count; ++i) {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        blocks[i] = seed;
+    }
+    if (bits % BLOCK_BITS != 0) {
+        blocks[count - 1] &= (1UL << (bits % BLOCK_BITS)) - 1;
+    }
+    return array;
+}
+
+static void benchSize(size_t bits) {
+    const size_t bytes = (bits + 7) / 8;
+    const size_t bitOps = bits < MAX_BIT_OPS ? bits : MAX_BIT_OPS;
+    // Размеры - степени двойки, так что (i * нечётное) & mask обходит биты вразброс
+    const size_t mask = bits - 1;
+    const size_t stride = 0x9e3779b1;
+
+    report("construct", bits, measure([&]() {
+        BitArray array(static_cast<int>(bits));
+        g_sink = array.bit_count();
+    }), 1, bytes);
+
+    BitArray a = randomArray(bits, 1);
+    BitArray b = randomArray(bits, 2);
+
+    report("set", bits, measure([&]() {
+        for (size_t i = 0; i < bitOps; ++i) {
+            a.set(static_cast<int>((i * stride) & mask), (i & 1) != 0);
+        }
+    }), bitOps, 0);
+
+    report("operator[]", bits, measure([&]() {
+        size_t ones = 0;
+        const BitArray& view = a;
+        for (size_t i = 0; i < bitOps; ++i) {
+            ones += view[static_cast<int>((i * stride) & mask)];
+        }
+        g_sink = ones;
+    }), bitOps, 0);
+
+    report("count", bits, measure([&]() { g_sink = a.count(); }), 1, bytes);
+    report("&=", bits, measure([&]() { a &= b; }), 1, 2 * bytes);
+    report("|=", bits, measure([&]() { a |= b; }), 1, 2 * bytes);
+    report("^=", bits, measure([&]() { a ^= b; }), 1, 2 * bytes);
+    report("a & ~b", bits, measure([&]() {
+        BitArray result = a & ~b;
+        g_sink = result.bit_count();
+    }), 1, 3 * bytes);
+    report("<<= 13", bits, measure([&]() { a <<= 13; }), 1, bytes);
+    report(">>= 13", bits, measure([&]() { a >>= 13; }), 1, bytes);
+
+    report("push_back", bits, measure([&]() {
+        BitArray array;
+        for (size_t i = 0; i < bitOps; ++i) {
+            array.push_back((i & 1) != 0);
+        }
+        g_sink = array.bit_count();
+    }), bitOps, 0);
+
+    report("resize x2", bits, measure([&]() {
+        BitArray array(1);
+        for (size_t size = 2; size <= bits; size *= 2) {
+            array.resize(static_cast<int>(size), true);
+        }
+        g_sink = array.bit_count();
+    }), 1, bytes);
+
+    report("to_string", bits, measure([&]() {
+        std::string text = b.to_string();
+        g_sink = text.size();
+    }), 1, bytes);
+}
+
+int main(int argc, char* argv[]) {
+    size_t maxBits = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : size_t(1) << 30;
+
+    std::printf("%-14s %12s %14s %10s\n", "operation", "bits", "ns/op", "GB/s");
+    for (size_t bits = 64; bits <= maxBits; bits *= 64) {
+        benchSize(bits);
+    }
+    return 0;
+}
@@ -0,0 +1,24 @@
+#include "BitArena.h"
+
+BitArena::BitArena(size_t initial_size, std::pmr::memory_resource* upstream)
+    : m_pool(initial_size, upstream), m_allocated(0) {}
+
+// Frees all buffers handed out by the arena
+void BitArena::release() {
+    m_pool.release();
+    m_allocated = 0;
+}
+
+void* BitArena::do_allocate(size_t bytes, size_t alignment) {
+    // Counted only once the pool has actually handed out the memory
+    void* ptr = m_pool.allocate(bytes, alignment > ALIGNMENT ? alignment : ALIGNMENT);
+    m_allocated += bytes;
+    return ptr;
+}
+
+// Individual buffers are only reclaimed by release()
+void BitArena::do_deallocate(void*, size_t, size_t) {}
+
+bool BitArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
@@ -0,0 +1,45 @@
+#ifndef BITARENA_H
+#define BITARENA_H
+
+#include <cstddef>
+#include <memory_resource>
+
+// Monotonic arena for short-lived bit arrays.
+//
+// Buffers are carved from large chunks and never freed one by one;
+// release() drops everything at once. Every buffer is cache-line aligned.
+// Arrays using the arena must not outlive it, and their contents are gone
+// after release(), so clear or destroy them first.
+//
+//   BitArena arena;
+//   BitArray mask(100000, 0, &arena);
+//   ...
+//   arena.release();
+class BitArena : public std::pmr::memory_resource {
+private:
+    static const size_t ALIGNMENT = 64;
+
+    std::pmr::monotonic_buffer_resource m_pool;
+    size_t m_allocated; // Bytes handed out since the last release()
+
+public:
+    // initial_size is the size of the first chunk, later chunks grow geometrically
+    explicit BitArena(size_t initial_size = 64 * 1024,
+                      std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+
+    BitArena(const BitArena&) = delete;
+    BitArena& operator=(const BitArena&) = delete;
+
+    // Frees all buffers handed out by the arena
+    void release();
+
+    // Returns number of bytes handed out since the last release()
+    size_t allocated() const { return m_allocated; }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+};
+
+#endif // BITARENA_H
@@ -1,19 +1,110 @@
 #include "BitArray.h"
+#include "BitArrayFormat.h"
+#include "BitOps.h"
 #include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <cstring>
 #include <stdexcept>
 #include <string>
 
+namespace {
+
+// Eight '0'/'1' characters for every byte value, bit 0 first
+struct ByteCharTable {
+    char chars[256][8];
+    
+    ByteCharTable() {
+        for (int value = 0; value < 256; ++value) {
+            for (int bit = 0; bit < 8; ++bit) {
+                chars[value][bit] = ((value >> bit) & 1) ? '1' : '0';
+            }
+        }
+    }
+};
+
+const ByteCharTable& byte_chars() {
+    static const ByteCharTable table;
+    return table;
+}
+
+// Blocks and header fields are stored little-endian whatever the host order
+uint64_t to_little_endian(uint64_t value) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return __builtin_bswap64(value);
+#else
+    return value;
+#endif
+}
+
+uint32_t to_little_endian(uint32_t value) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return __builtin_bswap32(value);
+#else
+    return value;
+#endif
+}
+
+// Converts the numeric header fields between host and file order (the
+// conversion is its own inverse, so it serves both directions)
+void swap_header_order(BitArrayFileHeader& header) {
+    header.version = to_little_endian(header.version);
+    header.header_size = to_little_endian(header.header_size);
+    header.bit_count = to_little_endian(header.bit_count);
+    header.flags = to_little_endian(header.flags);
+    header.reserved = to_little_endian(header.reserved);
+    header.payload_size = to_little_endian(header.payload_size);
+}
+
+void append_block(std::string& out, uint64_t value) {
+    value = to_little_endian(value);
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void append_varint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out += static_cast<char>((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+// Reads a LEB128 number at pos, advancing it
+uint64_t read_varint(const std::string& in, size_t& pos) {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (pos >= in.size()) {
+            break;
+        }
+        uint8_t byte = static_cast<uint8_t>(in[pos++]);
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+    }
+    throw std::invalid_argument("Invalid bit array data: truncated run length");
+}
+
+} // namespace
+
 // Constructs an empty bit array
-BitArray::BitArray() : m_data(nullptr), m_bit_count(0), m_array_size(0) {}
+BitArray::BitArray()
+    : m_data(nullptr), m_bit_count(0), m_array_size(0),
+      m_resource(std::pmr::get_default_resource()) {}
+
+// Constructs an empty bit array taking its buffers from resource
+BitArray::BitArray(std::pmr::memory_resource* resource)
+    : m_data(nullptr), m_bit_count(0), m_array_size(0), m_resource(resource) {}
 
 // Destructor
 BitArray::~BitArray() {
-    delete[] m_data;
+    release();
 }
 
 // Constructs a bit array storing specified number of bits
-BitArray::BitArray(int num_bits, unsigned long value) 
-    : m_data(nullptr), m_bit_count(0), m_array_size(0) {
+BitArray::BitArray(int num_bits, unsigned long value, std::pmr::memory_resource* resource)
+    : m_data(nullptr), m_bit_count(0), m_array_size(0), m_resource(resource) {
     
     if (num_bits < 0) {
         throw std::invalid_argument("BitArray size cannot be negative");
@@ -24,49 +115,157 @@ BitArray::BitArray(int num_bits, unsigned long value)
     }
     
     m_bit_count = static_cast<size_t>(num_bits);
-    m_array_size = (m_bit_count + BITS_PER_BLOCK - 1) / BITS_PER_BLOCK;
-    
-    if (m_array_size > 0) {
-        m_data = new unsigned long[m_array_size]();
-        if (num_bits > 0) {
-            m_data[0] = value; // Initialize only first block as per specification
-        }
+    allocate(used_blocks());
+    m_data[0] = value; // Initialize only first block as per specification
+    clear_unused_bits();
+}
+
+// Zeroes the bits past m_bit_count in the last used block
+void BitArray::clear_unused_bits() {
+    size_t bits_in_last_block = m_bit_count % BITS_PER_BLOCK;
+    if (m_data != nullptr && bits_in_last_block > 0) {
+        m_data[used_blocks() - 1] &= (1UL << bits_in_last_block) - 1;
     }
 }
 
-// Copy constructor
-BitArray::BitArray(const BitArray& other) 
-    : m_bit_count(other.m_bit_count), m_array_size(other.m_array_size) {
-    if (m_array_size > 0) {
-        m_data = new unsigned long[m_array_size];
-        for (size_t i = 0; i < m_array_size; ++i) {
-            m_data[i] = other.m_data[i];
+// Replaces storage with zeroed room for num_blocks blocks
+void BitArray::allocate(size_t num_blocks) {
+    if (num_blocks <= INLINE_BLOCKS) {
+        release();
+        if (num_blocks > 0) {
+            m_data = m_inline;
+            m_array_size = INLINE_BLOCKS;
         }
+    } else if (num_blocks != m_array_size || is_inline()) {
+        unsigned long* new_data = allocate_blocks(num_blocks);
+        release();
+        m_data = new_data;
+        m_array_size = num_blocks;
+    }
+    std::fill(m_data, m_data + m_array_size, 0UL);
+}
+
+// Grows capacity to num_blocks blocks keeping contents
+void BitArray::reallocate(size_t num_blocks) {
+    if (num_blocks <= m_array_size) {
+        return;
+    }
+    
+    if (num_blocks <= INLINE_BLOCKS) {
+        // Only reachable from an empty array
+        m_data = m_inline;
+        m_array_size = INLINE_BLOCKS;
+        std::fill(m_inline, m_inline + INLINE_BLOCKS, 0UL);
+        return;
+    }
+    
+    unsigned long* new_data = allocate_blocks(num_blocks);
+    if (m_data != nullptr) {
+        std::copy(m_data, m_data + m_array_size, new_data);
+    }
+    std::fill(new_data + m_array_size, new_data + num_blocks, 0UL);
+    
+    release();
+    m_data = new_data;
+    m_array_size = num_blocks;
+}
+
+// Frees heap storage, the bit count is left to the caller
+void BitArray::release() {
+    if (m_data != nullptr && !is_inline()) {
+        deallocate_blocks(m_data, m_array_size);
+    }
+    m_data = nullptr;
+    m_array_size = 0;
+}
+
+// Raw buffer allocation through m_resource, aligned to a cache line
+unsigned long* BitArray::allocate_blocks(size_t num_blocks) {
+    void* blocks = m_resource->allocate(num_blocks * sizeof(unsigned long), BLOCK_ALIGNMENT);
+    return static_cast<unsigned long*>(blocks);
+}
+
+void BitArray::deallocate_blocks(unsigned long* blocks, size_t num_blocks) {
+    m_resource->deallocate(blocks, num_blocks * sizeof(unsigned long), BLOCK_ALIGNMENT);
+}
+
+// Takes storage of other, leaving it empty. Inline blocks have to be copied.
+void BitArray::steal(BitArray& other) noexcept {
+    if (other.is_inline()) {
+        std::copy(other.m_inline, other.m_inline + INLINE_BLOCKS, m_inline);
+        m_data = m_inline;
     } else {
-        m_data = nullptr;
+        m_data = other.m_data;
     }
+    m_bit_count = other.m_bit_count;
+    m_array_size = other.m_array_size;
+    m_resource = other.m_resource;
+    
+    other.m_data = nullptr;
+    other.m_bit_count = 0;
+    other.m_array_size = 0;
+}
+
+// Copy constructor
+BitArray::BitArray(const BitArray& other)
+    : BitArray(other, std::pmr::get_default_resource()) {}
+
+// Copy constructor placing the copy into resource
+BitArray::BitArray(const BitArray& other, std::pmr::memory_resource* resource)
+    : m_data(nullptr), m_bit_count(0), m_array_size(0), m_resource(resource) {
+    if (other.m_bit_count > 0) {
+        allocate(other.used_blocks());
+        std::copy(other.m_data, other.m_data + other.used_blocks(), m_data);
+        m_bit_count = other.m_bit_count;
+    }
+}
+
+// Move constructor
+BitArray::BitArray(BitArray&& other) noexcept
+    : m_data(nullptr), m_bit_count(0), m_array_size(0), m_resource(other.m_resource) {
+    steal(other);
 }
 
 // Swaps values of two bit arrays
-void BitArray::swap(BitArray& other) {
-    std::swap(m_data, other.m_data);
-    std::swap(m_bit_count, other.m_bit_count);
-    std::swap(m_array_size, other.m_array_size);
+void BitArray::swap(BitArray& other) noexcept {
+    if (!is_inline() && !other.is_inline()) {
+        std::swap(m_data, other.m_data);
+        std::swap(m_bit_count, other.m_bit_count);
+        std::swap(m_array_size, other.m_array_size);
+        std::swap(m_resource, other.m_resource);
+        return;
+    }
+    
+    BitArray tmp(std::move(other));
+    other = std::move(*this);
+    *this = std::move(tmp);
 }
 
 // Assignment operator
 BitArray& BitArray::operator=(const BitArray& other) {
     if (this != &other) {
-        delete[] m_data;
+        size_t other_blocks = other.used_blocks();
+        
+        if (other_blocks > m_array_size) {
+            allocate(other_blocks);
+        } else if (m_data != nullptr) {
+            // Reuse current storage, blocks past the new size must stay zero
+            std::fill(m_data + other_blocks, m_data + used_blocks(), 0UL);
+        }
+        
+        if (other_blocks > 0) {
+            std::copy(other.m_data, other.m_data + other_blocks, m_data);
+        }
         m_bit_count = other.m_bit_count;
-        m_array_size = other.m_array_size;
+    }
+    return *this;
+}
 
-        if (m_array_size > 0) {
-            m_data = new unsigned long[m_array_size];
-            std::copy(other.m_data, other.m_data + m_array_size, m_data);
-        } else {
-            m_data = nullptr;
-        }
+// Move assignment
+BitArray& BitArray::operator=(BitArray&& other) noexcept {
+    if (this != &other) {
+        release();
+        steal(other);
     }
     return *this;
 }
@@ -82,58 +281,42 @@ void BitArray::resize(int num_bits, bool value) {
         return;
     }
 
-    size_t new_array_size = (new_bit_count + BITS_PER_BLOCK - 1) / BITS_PER_BLOCK;
-    unsigned long* new_data = new unsigned long[new_array_size];
-    unsigned long fill_value = value ? ~0UL : 0UL;
-    
-    // Initialize new array with fill value
-    for (size_t i = 0; i < new_array_size; ++i) {
-        new_data[i] = fill_value;
-    }
-    
-    // Copy existing data
-    size_t min_array_size = std::min(m_array_size, new_array_size);
-    if (min_array_size > 0 && m_data != nullptr) {
-        std::copy(m_data, m_data + min_array_size, new_data);
-    }
+    size_t old_blocks = used_blocks();
+    size_t new_blocks = (new_bit_count + BITS_PER_BLOCK - 1) / BITS_PER_BLOCK;
 
-    // Trim excess bits if shrinking
-    if (new_bit_count < m_bit_count && new_array_size > 0) {
-        size_t bits_in_last_block = new_bit_count % BITS_PER_BLOCK;
-        if (bits_in_last_block > 0) {
-            unsigned long mask = (1UL << bits_in_last_block) - 1;
-            new_data[new_array_size - 1] &= mask;
+    if (new_bit_count > m_bit_count) {
+        reallocate(new_blocks);
+        
+        if (value) {
+            // Fill the rest of the old last block, then whole new blocks
+            size_t bits_in_last_block = m_bit_count % BITS_PER_BLOCK;
+            if (bits_in_last_block > 0) {
+                m_data[old_blocks - 1] |= ~0UL << bits_in_last_block;
+            }
+            std::fill(m_data + old_blocks, m_data + new_blocks, ~0UL);
         }
+        
+        m_bit_count = new_bit_count;
+        clear_unused_bits();
+    } else {
+        // Shrinking keeps the capacity, dropped bits are zeroed
+        m_bit_count = new_bit_count;
+        std::fill(m_data + new_blocks, m_data + old_blocks, 0UL);
+        clear_unused_bits();
     }
-    
-    delete[] m_data;
-    m_data = new_data;
-    m_bit_count = new_bit_count;
-    m_array_size = new_array_size;
 }
 
 // Clears the array
 void BitArray::clear() {
-    delete[] m_data;
-    m_data = nullptr;
+    release();
     m_bit_count = 0;
-    m_array_size = 0;
 }
 
 // Adds a new bit to the end of array
 void BitArray::push_back(bool bit) {
     // Check if reallocation is needed
     if (m_bit_count >= m_array_size * BITS_PER_BLOCK) {
-        size_t new_array_size = (m_array_size == 0) ? 1 : m_array_size * 2;
-        unsigned long* new_data = new unsigned long[new_array_size]();
-        
-        if (m_data != nullptr) {
-            std::copy(m_data, m_data + m_array_size, new_data);
-            delete[] m_data;
-        }
-        
-        m_data = new_data;
-        m_array_size = new_array_size;
+        reallocate((m_array_size == 0) ? 1 : m_array_size * 2);
     }
     
     // Set the bit if needed
@@ -156,7 +339,7 @@ BitArray& BitArray::operator&=(const BitArray& other) {
         return *this;
     }
     
-    for (size_t i = 0; i < m_array_size; ++i) {
+    for (size_t i = 0; i < used_blocks(); ++i) {
         m_data[i] &= other.m_data[i];
     }
     
@@ -173,7 +356,7 @@ BitArray& BitArray::operator|=(const BitArray& other) {
         return *this;
     }
     
-    for (size_t i = 0; i < m_array_size; ++i) {
+    for (size_t i = 0; i < used_blocks(); ++i) {
         m_data[i] |= other.m_data[i];
     }
     
@@ -190,14 +373,49 @@ BitArray& BitArray::operator^=(const BitArray& other) {
         return *this;
     }
     
-    for (size_t i = 0; i < m_array_size; ++i) {
+    for (size_t i = 0; i < used_blocks(); ++i) {
         m_data[i] ^= other.m_data[i];
     }
     
     return *this;
 }
 
-// Left shift assignment
+// Block-wise Op with other, split over the policy's pool
+template <class Op>
+BitArray& BitArray::combine_parallel(const BitArray& other, const ParallelPolicy& policy) {
+    if (m_bit_count != other.m_bit_count) {
+        throw std::invalid_argument(std::string("Bit arrays must be of same size for ")
+                                    + Op::name() + " operation");
+    }
+    
+    unsigned long* dst = m_data;
+    const unsigned long* src = other.m_data;
+    policy.get_pool().parallel_for(used_blocks(), PARALLEL_GRAIN_BLOCKS, [=](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            dst[i] = Op::apply(dst[i], src[i]);
+        }
+    });
+    return *this;
+}
+
+// Parallel bitwise AND
+BitArray& BitArray::and_with(const BitArray& other, const ParallelPolicy& policy) {
+    return combine_parallel<BitAndOp>(other, policy);
+}
+
+// Parallel bitwise OR
+BitArray& BitArray::or_with(const BitArray& other, const ParallelPolicy& policy) {
+    return combine_parallel<BitOrOp>(other, policy);
+}
+
+// Parallel bitwise XOR
+BitArray& BitArray::xor_with(const BitArray& other, const ParallelPolicy& policy) {
+    return combine_parallel<BitXorOp>(other, policy);
+}
+
+// Left shift assignment: bit i takes the value of bit i + n.
+// Works on whole blocks: the word part of the shift is a memmove and the
+// remaining bit part is a funnel shift of each block with its upper neighbour.
 BitArray& BitArray::operator<<=(int n) {
     if (n < 0) {
         throw std::invalid_argument("Shift amount cannot be negative");
@@ -215,20 +433,28 @@ BitArray& BitArray::operator<<=(int n) {
         return *this;
     }
     
-    // Perform shift
-    for (size_t i = 0; i < m_bit_count - shift_bits; ++i) {
-        set(static_cast<int>(i), (*this)[static_cast<int>(i + shift_bits)]);
+    size_t blocks = used_blocks();
+    size_t word_shift = shift_bits / BITS_PER_BLOCK;
+    size_t bit_shift = shift_bits % BITS_PER_BLOCK;
+    size_t kept = blocks - word_shift;
+    
+    if (word_shift > 0) {
+        std::memmove(m_data, m_data + word_shift, kept * sizeof(unsigned long));
+        std::fill(m_data + kept, m_data + blocks, 0UL);
     }
     
-    // Fill remaining bits with zeros
-    for (size_t i = m_bit_count - shift_bits; i < m_bit_count; ++i) {
-        reset(static_cast<int>(i));
+    if (bit_shift > 0) {
+        for (size_t i = 0; i + 1 < kept; ++i) {
+            m_data[i] = (m_data[i] >> bit_shift) | (m_data[i + 1] << (BITS_PER_BLOCK - bit_shift));
+        }
+        m_data[kept - 1] >>= bit_shift;
     }
     
     return *this;
 }
 
-// Right shift assignment
+// Right shift assignment: bit i takes the value of bit i - n.
+// Mirror of operator<<=, walking blocks from the end to avoid overwriting.
 BitArray& BitArray::operator>>=(int n) {
     if (n < 0) {
         throw std::invalid_argument("Shift amount cannot be negative");
@@ -246,29 +472,39 @@ BitArray& BitArray::operator>>=(int n) {
         return *this;
     }
     
-    // Perform shift from the end to avoid overwriting
-    for (int i = static_cast<int>(m_bit_count) - 1; i >= static_cast<int>(shift_bits); --i) {
-        set(i, (*this)[i - shift_bits]);
+    size_t blocks = used_blocks();
+    size_t word_shift = shift_bits / BITS_PER_BLOCK;
+    size_t bit_shift = shift_bits % BITS_PER_BLOCK;
+    size_t kept = blocks - word_shift;
+    
+    if (word_shift > 0) {
+        std::memmove(m_data + word_shift, m_data, kept * sizeof(unsigned long));
+        std::fill(m_data, m_data + word_shift, 0UL);
     }
     
-    // Fill beginning bits with zeros
-    for (size_t i = 0; i < shift_bits; ++i) {
-        reset(static_cast<int>(i));
+    if (bit_shift > 0) {
+        for (size_t i = blocks - 1; i > word_shift; --i) {
+            m_data[i] = (m_data[i] << bit_shift) | (m_data[i - 1] >> (BITS_PER_BLOCK - bit_shift));
+        }
+        m_data[word_shift] <<= bit_shift;
     }
     
+    // Bits pushed past the end must not stay in the last block
+    clear_unused_bits();
+    
     return *this;
 }
 
 // Left shift
 BitArray BitArray::operator<<(int n) const {
-    BitArray result(*this);
+    BitArray result(*this, m_resource);
     result <<= n;
     return result;
 }
 
 // Right shift
 BitArray BitArray::operator>>(int n) const {
-    BitArray result(*this);
+    BitArray result(*this, m_resource);
     result >>= n;
     return result;
 }
@@ -301,22 +537,33 @@ BitArray& BitArray::set() {
         return *this;
     }
     
-    for (size_t i = 0; i < m_array_size; ++i) {
-        m_data[i] = ~0UL;
-    }
+    std::fill(m_data, m_data + used_blocks(), ~0UL);
     
     // Clear excess bits in last block
-    if (m_array_size > 0) {
-        size_t bits_in_last_block = m_bit_count % BITS_PER_BLOCK;
-        if (bits_in_last_block > 0) {
-            unsigned long mask = (1UL << bits_in_last_block) - 1;
-            m_data[m_array_size - 1] &= mask;
-        }
-    }
+    clear_unused_bits();
     
     return *this;
 }
 
+// Sets all bits to true in parallel
+BitArray& BitArray::set(const ParallelPolicy& policy) {
+    unsigned long* dst = m_data;
+    policy.get_pool().parallel_for(used_blocks(), PARALLEL_GRAIN_BLOCKS, [=](size_t begin, size_t end) {
+        std::fill(dst + begin, dst + end, ~0UL);
+    });
+    clear_unused_bits();
+    return *this;
+}
+
+// Sets all bits to false in parallel
+BitArray& BitArray::reset(const ParallelPolicy& policy) {
+    unsigned long* dst = m_data;
+    policy.get_pool().parallel_for(used_blocks(), PARALLEL_GRAIN_BLOCKS, [=](size_t begin, size_t end) {
+        std::fill(dst + begin, dst + end, 0UL);
+    });
+    return *this;
+}
+
 // Sets bit at index n to false
 BitArray& BitArray::reset(int n) {
     return set(n, false);
@@ -348,43 +595,49 @@ bool BitArray::any() const {
     return false;
 }
 
+// Returns true if array contains at least one true bit, searching in parallel.
+// Tasks check a shared flag between steps and give up once a bit is found.
+bool BitArray::any(const ParallelPolicy& policy) const {
+    const size_t step = 512;
+    const unsigned long* src = m_data;
+    std::atomic<bool> found(false);
+    
+    policy.get_pool().parallel_for(used_blocks(), PARALLEL_GRAIN_BLOCKS, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end && !found.load(std::memory_order_relaxed); i += step) {
+            size_t stop = std::min(i + step, end);
+            for (size_t j = i; j < stop; ++j) {
+                if (src[j] != 0) {
+                    found.store(true, std::memory_order_relaxed);
+                    return;
+                }
+            }
+        }
+    });
+    return found.load();
+}
+
 // Returns true if all bits are false
 bool BitArray::none() const {
     return !any();
 }
 
-// Bitwise inversion
-BitArray BitArray::operator~() const {
-    BitArray result(*this);
-    if (result.m_data == nullptr) {
-        return result;
-    }
-    
-    for (size_t i = 0; i < result.m_array_size; ++i) {
-        result.m_data[i] = ~result.m_data[i];
-    }
-    
-    // Clear excess bits in last block
-    if (result.m_array_size > 0) {
-        size_t bits_in_last_block = result.m_bit_count % BITS_PER_BLOCK;
-        if (bits_in_last_block > 0) {
-            unsigned long mask = (1UL << bits_in_last_block) - 1;
-            result.m_data[result.m_array_size - 1] &= mask;
-        }
+// Counts number of true bits, a block at a time (bits past the size are always zero)
+size_t BitArray::count() const {
+    if (m_data == nullptr) {
+        return 0;
     }
-    
-    return result;
+    return bitops::popcount(m_data, used_blocks());
 }
 
-// Counts number of true bits
-int BitArray::count() const {
-    int count = 0;
-    for (size_t i = 0; i < m_bit_count; ++i) {
-        if ((*this)[i]) {
-            count++;
-        }
-    }
-    return count;
+// Counts number of true bits in parallel
+size_t BitArray::count(const ParallelPolicy& policy) const {
+    const unsigned long* src = m_data;
+    std::atomic<size_t> total(0);
+    
+    policy.get_pool().parallel_for(used_blocks(), PARALLEL_GRAIN_BLOCKS, [&](size_t begin, size_t end) {
+        total.fetch_add(bitops::popcount(src + begin, end - begin), std::memory_order_relaxed);
+    });
+    return total.load();
 }
 
 // Returns value of bit at index i (const version)
@@ -420,12 +673,222 @@ bool BitArray::empty() const {
     return m_bit_count == 0;
 }
 
-// Returns string representation of array
+// Returns index of the first true bit, or npos
+size_t BitArray::find_first() const {
+    for (size_t i = 0; i < used_blocks(); ++i) {
+        if (m_data[i] != 0) {
+            return i * BITS_PER_BLOCK + static_cast<size_t>(__builtin_ctzl(m_data[i]));
+        }
+    }
+    return npos;
+}
+
+// Returns index of the first true bit after pos, or npos
+size_t BitArray::find_next(size_t pos) const {
+    if (pos == npos || pos + 1 >= m_bit_count) {
+        return npos;
+    }
+    
+    size_t next = pos + 1;
+    size_t block_idx = block_index(next);
+    
+    // Rest of the block holding pos + 1
+    unsigned long word = m_data[block_idx] & (~0UL << bit_offset(next));
+    if (word != 0) {
+        return block_idx * BITS_PER_BLOCK + static_cast<size_t>(__builtin_ctzl(word));
+    }
+    
+    for (size_t i = block_idx + 1; i < used_blocks(); ++i) {
+        if (m_data[i] != 0) {
+            return i * BITS_PER_BLOCK + static_cast<size_t>(__builtin_ctzl(m_data[i]));
+        }
+    }
+    return npos;
+}
+
+// Returns index of the last true bit, or npos
+size_t BitArray::find_last() const {
+    for (size_t i = used_blocks(); i > 0; --i) {
+        if (m_data[i - 1] != 0) {
+            return i * BITS_PER_BLOCK - 1 - static_cast<size_t>(__builtin_clzl(m_data[i - 1]));
+        }
+    }
+    return npos;
+}
+
+// Returns string representation of array, eight characters per table lookup
 std::string BitArray::to_string() const {
-    std::string result;
-    for (size_t i = 0; i < m_bit_count; ++i) {
-        result += ((*this)[i] ? '1' : '0');
+    std::string result(m_bit_count, '0');
+    const ByteCharTable& table = byte_chars();
+    char* out = &result[0];
+    
+    size_t full_bytes = m_bit_count / 8;
+    for (size_t i = 0; i < full_bytes; ++i) {
+        unsigned char byte = static_cast<unsigned char>(m_data[i / sizeof(unsigned long)] >> (8 * (i % sizeof(unsigned long))));
+        std::memcpy(out + 8 * i, table.chars[byte], 8);
     }
+    
+    for (size_t i = full_bytes * 8; i < m_bit_count; ++i) {
+        out[i] = ((m_data[block_index(i)] >> bit_offset(i)) & 1) ? '1' : '0';
+    }
+    return result;
+}
+
+// Parses a to_string() representation, eight characters at a time
+BitArray BitArray::from_string(const std::string& str) {
+    if (str.size() > static_cast<size_t>(INT_MAX)) {
+        throw std::length_error("String is too long for BitArray");
+    }
+    
+    BitArray result(static_cast<int>(str.size()));
+    const char* in = str.data();
+    size_t full_bytes = str.size() / 8;
+    
+    for (size_t i = 0; i < full_bytes; ++i) {
+        uint64_t chars;
+        std::memcpy(&chars, in + 8 * i, 8);
+        chars = to_little_endian(chars);
+        
+        // Every byte must be 0x30 or 0x31
+        if ((chars & 0xfefefefefefefefeULL) != 0x3030303030303030ULL) {
+            throw std::invalid_argument("Invalid character in bit string");
+        }
+        
+        // Gathers the low bit of byte j into bit 56 + j
+        uint64_t byte = ((chars & 0x0101010101010101ULL) * 0x0102040810204080ULL) >> 56;
+        result.m_data[i / sizeof(unsigned long)] |= static_cast<unsigned long>(byte) << (8 * (i % sizeof(unsigned long)));
+    }
+    
+    for (size_t i = full_bytes * 8; i < str.size(); ++i) {
+        if (in[i] != '0' && in[i] != '1') {
+            throw std::invalid_argument("Invalid character in bit string");
+        }
+        if (in[i] == '1') {
+            result.m_data[result.block_index(i)] |= result.bit_mask(i);
+        }
+    }
+    return result;
+}
+
+// Binary snapshot: header and little-endian blocks, optionally run-length encoded
+std::string BitArray::to_bytes(bool compress) const {
+    std::string payload;
+    size_t blocks = used_blocks();
+    
+    if (!compress) {
+        payload.reserve(blocks * sizeof(uint64_t));
+        for (size_t i = 0; i < blocks; ++i) {
+            append_block(payload, m_data[i]);
+        }
+    } else {
+        size_t i = 0;
+        while (i < blocks) {
+            unsigned long value = m_data[i];
+            size_t run = i + 1;
+            
+            if (value == 0 || value == ~0UL) {
+                while (run < blocks && m_data[run] == value) {
+                    ++run;
+                }
+                payload += static_cast<char>(value == 0 ? RLE_ZEROS : RLE_ONES);
+                append_varint(payload, run - i);
+            } else {
+                // Literal blocks up to the next fill block
+                while (run < blocks && m_data[run] != 0 && m_data[run] != ~0UL) {
+                    ++run;
+                }
+                payload += static_cast<char>(RLE_WORDS);
+                append_varint(payload, run - i);
+                for (size_t j = i; j < run; ++j) {
+                    append_block(payload, m_data[j]);
+                }
+            }
+            i = run;
+        }
+    }
+    
+    BitArrayFileHeader header = {};
+    std::memcpy(header.magic, BITARRAY_MAGIC, sizeof(header.magic));
+    header.version = BitArrayFileHeader::CURRENT_VERSION;
+    header.header_size = sizeof(BitArrayFileHeader);
+    header.bit_count = m_bit_count;
+    header.flags = compress ? BITARRAY_RLE : BITARRAY_RAW;
+    header.payload_size = payload.size();
+    swap_header_order(header);
+    
+    std::string result(reinterpret_cast<const char*>(&header), sizeof(header));
+    result += payload;
+    return result;
+}
+
+// Restores a to_bytes() snapshot
+BitArray BitArray::from_bytes(const std::string& bytes) {
+    BitArrayFileHeader header;
+    if (bytes.size() < sizeof(header)) {
+        throw std::invalid_argument("Invalid bit array data: too short");
+    }
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    swap_header_order(header);
+    
+    if (std::memcmp(header.magic, BITARRAY_MAGIC, sizeof(header.magic)) != 0
+        || header.version != BitArrayFileHeader::CURRENT_VERSION
+        || header.header_size != sizeof(BitArrayFileHeader)
+        || header.payload_size != bytes.size() - sizeof(header)) {
+        throw std::invalid_argument("Invalid bit array data: bad header");
+    }
+    if (header.bit_count > static_cast<uint64_t>(INT_MAX)) {
+        throw std::length_error("Bit array data is too large for BitArray");
+    }
+    
+    BitArray result(static_cast<int>(header.bit_count));
+    size_t blocks = result.used_blocks();
+    size_t pos = sizeof(header);
+    
+    auto read_block = [&](size_t index) {
+        uint64_t value;
+        std::memcpy(&value, bytes.data() + pos, sizeof(value));
+        result.m_data[index] = static_cast<unsigned long>(to_little_endian(value));
+        pos += sizeof(value);
+    };
+    
+    if (header.flags == BITARRAY_RAW) {
+        if (header.payload_size != blocks * sizeof(uint64_t)) {
+            throw std::invalid_argument("Invalid bit array data: wrong payload size");
+        }
+        for (size_t i = 0; i < blocks; ++i) {
+            read_block(i);
+        }
+    } else if (header.flags == BITARRAY_RLE) {
+        size_t block = 0;
+        while (pos < bytes.size()) {
+            uint8_t tag = static_cast<uint8_t>(bytes[pos++]);
+            uint64_t count = read_varint(bytes, pos);
+            if (count > blocks - block) {
+                throw std::invalid_argument("Invalid bit array data: run past the end");
+            }
+            
+            if (tag == RLE_ZEROS || tag == RLE_ONES) {
+                std::fill(result.m_data + block, result.m_data + block + count, tag == RLE_ONES ? ~0UL : 0UL);
+            } else if (tag == RLE_WORDS) {
+                if (count * sizeof(uint64_t) > bytes.size() - pos) {
+                    throw std::invalid_argument("Invalid bit array data: truncated blocks");
+                }
+                for (size_t j = 0; j < count; ++j) {
+                    read_block(block + j);
+                }
+            } else {
+                throw std::invalid_argument("Invalid bit array data: unknown run tag");
+            }
+            block += count;
+        }
+        if (block != blocks) {
+            throw std::invalid_argument("Invalid bit array data: missing blocks");
+        }
+    } else {
+        throw std::invalid_argument("Invalid bit array data: unknown encoding");
+    }
+    
+    result.clear_unused_bits();
     return result;
 }
 
@@ -447,24 +910,3 @@ bool operator==(const BitArray& a, const BitArray& b) {
 bool operator!=(const BitArray& a, const BitArray& b) {
     return !(a == b);
 }
-
-// Bitwise AND
-BitArray operator&(const BitArray& b1, const BitArray& b2) {
-    BitArray result(b1);
-    result &= b2;
-    return result;
-}
-
-// Bitwise OR
-BitArray operator|(const BitArray& b1, const BitArray& b2) {
-    BitArray result(b1);
-    result |= b2;
-    return result;
-}
-
-// Bitwise XOR
-BitArray operator^(const BitArray& b1, const BitArray& b2) {
-    BitArray result(b1);
-    result ^= b2;
-    return result;
-}
\ No newline at end of file
@@ -4,22 +4,61 @@
 #include <cstddef>
 #include <stdexcept>
 #include <algorithm>
+#include <iterator>
+#include <memory_resource>
 #include <string>
+#include "BitExpr.h"
+#include "ThreadPool.h"
 
-class BitArray
+class BitArray : public BitExpr<BitArray>
 {
 private:
-    unsigned long* m_data;
-    size_t m_bit_count; // Number of bits stored
-    size_t m_array_size; // Size of m_data array in elements
-    
     static const size_t BITS_PER_BLOCK = sizeof(unsigned long) * 8;
+    
+    // Arrays up to INLINE_BLOCKS blocks live in m_inline and never touch the heap
+    static const size_t INLINE_BLOCKS = 4;
+    
+    // Larger buffers are aligned to a cache line
+    static const size_t BLOCK_ALIGNMENT = 64;
+    
+    // Blocks per task of a parallel operation: 64 KiB, a whole number of cache lines
+    static const size_t PARALLEL_GRAIN_BLOCKS = 8192;
+
+    unsigned long* m_data; // nullptr, m_inline or a buffer from m_resource
+    size_t m_bit_count; // Number of bits stored
+    size_t m_array_size; // Size of m_data array in elements (capacity)
+    std::pmr::memory_resource* m_resource; // Source of non-inline buffers
+    unsigned long m_inline[INLINE_BLOCKS];
 
     // Helper methods for bit manipulation
     size_t block_index(size_t bit_pos) const { return bit_pos / BITS_PER_BLOCK; }
     size_t bit_offset(size_t bit_pos) const { return bit_pos % BITS_PER_BLOCK; }
     unsigned long bit_mask(size_t bit_pos) const { return 1UL << bit_offset(bit_pos); }
 
+    // Number of blocks actually holding bits (m_array_size can be larger after push_back)
+    size_t used_blocks() const { return (m_bit_count + BITS_PER_BLOCK - 1) / BITS_PER_BLOCK; }
+
+    // Zeroes the bits past m_bit_count in the last used block
+    void clear_unused_bits();
+
+    // Storage management. Every block past the used ones is kept zero.
+    bool is_inline() const { return m_data == m_inline; }
+    // Replaces storage with zeroed room for num_blocks blocks, contents are dropped
+    void allocate(size_t num_blocks);
+    // Grows capacity to num_blocks blocks keeping contents, new blocks are zero
+    void reallocate(size_t num_blocks);
+    // Frees heap storage and drops m_data (m_bit_count is left untouched)
+    void release();
+    // Raw buffer allocation through m_resource
+    unsigned long* allocate_blocks(size_t num_blocks);
+    void deallocate_blocks(unsigned long* blocks, size_t num_blocks);
+    // Takes storage of other, leaving it empty
+    void steal(BitArray& other) noexcept;
+
+    // Block-wise Op (from BitExpr.h) with other, split over the policy's pool
+    template <class Op>
+    BitArray& combine_parallel(const BitArray& other, const ParallelPolicy& policy);
+
     // Proxy class for operator[] assignment
     class BitProxy {
     private:
@@ -67,21 +106,43 @@ public:
     // Constructs an empty bit array
     BitArray();
     
+    // Constructs an empty bit array taking its buffers from resource
+    explicit BitArray(std::pmr::memory_resource* resource);
+    
     // Destructor
     ~BitArray();
     
     // Constructs a bit array storing specified number of bits.
     // First sizeof(long) bits can be initialized with value parameter.
-    explicit BitArray(int num_bits, unsigned long value = 0);
+    // Buffers come from resource (the default resource if not given).
+    explicit BitArray(int num_bits, unsigned long value = 0,
+                      std::pmr::memory_resource* resource = std::pmr::get_default_resource());
     
-    // Copy constructor
+    // Copy constructor. As with std::pmr containers the copy uses the default resource.
     BitArray(const BitArray& other);
     
+    // Copy constructor placing the copy into resource
+    BitArray(const BitArray& other, std::pmr::memory_resource* resource);
+    
+    // Move constructor, other is left empty. The buffer keeps its resource.
+    BitArray(BitArray&& other) noexcept;
+    
     // Swaps values of two bit arrays
-    void swap(BitArray& other);
+    void swap(BitArray& other) noexcept;
     
     // Assignment operator
     BitArray& operator=(const BitArray& other);
+    
+    // Move assignment, other is left empty.
+    // The resource moves together with the buffer, so no copy is ever needed.
+    BitArray& operator=(BitArray&& other) noexcept;
+    
+    // Evaluates a bitwise expression (see BitExpr.h) in a single pass
+    template <class E>
+    BitArray(const BitExpr<E>& expr,
+             std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+    template <class E>
+    BitArray& operator=(const BitExpr<E>& expr);
 
     // Changes array size. When expanding, new elements are initialized with value.
     void resize(int num_bits, bool value = false);
@@ -96,8 +157,20 @@ public:
     BitArray& operator&=(const BitArray& other);
     BitArray& operator|=(const BitArray& other);
     BitArray& operator^=(const BitArray& other);
+    template <class E>
+    BitArray& operator&=(const BitExpr<E>& expr);
+    template <class E>
+    BitArray& operator|=(const BitExpr<E>& expr);
+    template <class E>
+    BitArray& operator^=(const BitExpr<E>& expr);
+    
+    // Same as &=, |= and ^=, with the block range split across a thread pool:
+    // a.and_with(b, par)
+    BitArray& and_with(const BitArray& other, const ParallelPolicy& policy);
+    BitArray& or_with(const BitArray& other, const ParallelPolicy& policy);
+    BitArray& xor_with(const BitArray& other, const ParallelPolicy& policy);
     
-    // Bitwise shift with zero fill
+    // Bitwise shift with zero fill. Shifted copies use the same resource.
     BitArray& operator<<=(int n);
     BitArray& operator>>=(int n);
     BitArray operator<<(int n) const;
@@ -114,6 +187,10 @@ public:
     
     // Sets all bits to false
     BitArray& reset();
+    
+    // Parallel versions of set() and reset()
+    BitArray& set(const ParallelPolicy& policy);
+    BitArray& reset(const ParallelPolicy& policy);
 
     // Returns true if array contains at least one true bit
     bool any() const;
@@ -121,11 +198,13 @@ public:
     // Returns true if all bits are false
     bool none() const;
     
-    // Bitwise inversion
-    BitArray operator~() const;
-    
     // Counts number of true bits
-    int count() const;
+    size_t count() const;
+    
+    // Parallel versions of any() and count().
+    // any() stops all workers as soon as one of them finds a true bit.
+    bool any(const ParallelPolicy& policy) const;
+    size_t count(const ParallelPolicy& policy) const;
 
     // Returns value of bit at index i (const version)
     bool operator[](int i) const;
@@ -136,20 +215,178 @@ public:
     // Returns size of array in bits
     int size() const;
     
+    // Expression interface: size in bits and raw block i (no bounds check)
+    size_t bit_count() const { return m_bit_count; }
+    unsigned long block(size_t i) const { return m_data[i]; }
+    
+    // Raw block storage, nullptr for an empty array. Writers must keep the
+    // bits past size() false.
+    const unsigned long* data() const { return m_data; }
+    unsigned long* data() { return m_data; }
+    
+    // Resource the array takes its buffers from
+    std::pmr::memory_resource* resource() const { return m_resource; }
+    
     // Returns true if array is empty
     bool empty() const;
     
-    // Returns string representation of array
+    // Returns string representation of array ('0'/'1' per bit, bit 0 first)
     std::string to_string() const;
+    
+    // Parses a to_string() representation. Throws std::invalid_argument on
+    // characters other than '0' and '1'.
+    static BitArray from_string(const std::string& str);
+    
+    // Binary snapshot: header and little-endian blocks (layout in BitArrayFormat.h).
+    // An uncompressed snapshot saved to a file can be opened by MappedBitArray.
+    // With compress set, runs of all-zero and all-one blocks are run-length encoded.
+    std::string to_bytes(bool compress = false) const;
+    
+    // Restores a to_bytes() snapshot. Throws std::invalid_argument on malformed data.
+    static BitArray from_bytes(const std::string& bytes);
+
+    // Returned by the find functions when there is no such bit
+    static const size_t npos = static_cast<size_t>(-1);
+
+    // Returns index of the first true bit, or npos
+    size_t find_first() const;
+    
+    // Returns index of the first true bit after pos, or npos
+    size_t find_next(size_t pos) const;
+    
+    // Returns index of the last true bit, or npos
+    size_t find_last() const;
+
+    // Forward iterator over indices of true bits, skipping zero blocks
+    class OnesIterator {
+    private:
+        const unsigned long* m_blocks;
+        size_t m_block_count;
+        size_t m_block;     // Current block index
+        unsigned long m_word; // Bits of the current block not visited yet
+
+        // Moves to the next non-zero block, or to m_block_count at the end
+        void skip_empty_blocks() {
+            while (m_word == 0 && m_block < m_block_count) {
+                if (++m_block < m_block_count) {
+                    m_word = m_blocks[m_block];
+                }
+            }
+        }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = size_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const size_t*;
+        using reference = size_t;
+
+        OnesIterator(const unsigned long* blocks, size_t block_count, size_t block)
+            : m_blocks(blocks), m_block_count(block_count), m_block(block),
+              m_word(block < block_count ? blocks[block] : 0) {
+            skip_empty_blocks();
+        }
+
+        size_t operator*() const {
+            return m_block * BITS_PER_BLOCK + static_cast<size_t>(__builtin_ctzl(m_word));
+        }
+
+        OnesIterator& operator++() {
+            m_word &= m_word - 1; // Drop the lowest set bit
+            skip_empty_blocks();
+            return *this;
+        }
+
+        OnesIterator operator++(int) {
+            OnesIterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const OnesIterator& other) const {
+            return m_block == other.m_block && m_word == other.m_word;
+        }
+        bool operator!=(const OnesIterator& other) const { return !(*this == other); }
+    };
+
+    // Range of true bit indices: for (size_t i : bits.ones()) ...
+    class OnesRange {
+    private:
+        const unsigned long* m_blocks;
+        size_t m_block_count;
+
+    public:
+        OnesRange(const unsigned long* blocks, size_t block_count)
+            : m_blocks(blocks), m_block_count(block_count) {}
+
+        OnesIterator begin() const { return OnesIterator(m_blocks, m_block_count, 0); }
+        OnesIterator end() const { return OnesIterator(m_blocks, m_block_count, m_block_count); }
+    };
+
+    // Returns range over indices of true bits in increasing order
+    OnesRange ones() const { return OnesRange(m_data, used_blocks()); }
 };
 
 // Comparison operators
 bool operator==(const BitArray& a, const BitArray& b);
 bool operator!=(const BitArray& a, const BitArray& b);
 
-// Bitwise operators
-BitArray operator&(const BitArray& b1, const BitArray& b2);
-BitArray operator|(const BitArray& b1, const BitArray& b2);
-BitArray operator^(const BitArray& b1, const BitArray& b2);
+// Bitwise operators &, |, ^ and ~ build lazy expressions, see BitExpr.h
+
+// Shifts of an expression materialize it first
+template <class E>
+BitArray operator<<(const BitExpr<E>& expr, int n) {
+    BitArray result(expr);
+    result <<= n;
+    return result;
+}
+
+template <class E>
+BitArray operator>>(const BitExpr<E>& expr, int n) {
+    BitArray result(expr);
+    result >>= n;
+    return result;
+}
+
+template <class E>
+BitArray::BitArray(const BitExpr<E>& expr, std::pmr::memory_resource* resource)
+    : m_data(nullptr), m_bit_count(0), m_array_size(0), m_resource(resource) {
+    *this = expr;
+}
+
+template <class E>
+BitArray& BitArray::operator=(const BitExpr<E>& expr) {
+    const E& e = expr.self();
+    
+    // A different size means this array is not an operand, storage can be replaced
+    if (e.bit_count() != m_bit_count) {
+        allocate(e.block_count());
+        m_bit_count = e.bit_count();
+    }
+    
+    // Operands are read at the same block index that is written, so
+    // expressions like a = a & b are safe to evaluate in place
+    size_t blocks = used_blocks();
+    for (size_t i = 0; i < blocks; ++i) {
+        m_data[i] = e.block(i);
+    }
+    clear_unused_bits();
+    return *this;
+}
+
+template <class E>
+BitArray& BitArray::operator&=(const BitExpr<E>& expr) {
+    return *this = *this & expr;
+}
+
+template <class E>
+BitArray& BitArray::operator|=(const BitExpr<E>& expr) {
+    return *this = *this | expr;
+}
+
+template <class E>
+BitArray& BitArray::operator^=(const BitExpr<E>& expr) {
+    return *this = *this ^ expr;
+}
 
 #endif // BITARRAY_H
\ No newline at end of file
@@ -0,0 +1,53 @@
+#ifndef BITARRAYFORMAT_H
+#define BITARRAYFORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Binary layout of a stored bit array:
+//
+//   offset 0   header (64 bytes, see BitArrayFileHeader)
+//   offset 64  payload
+//
+// All numeric header fields are little-endian, like the payload, so a file
+// written on one host reads the same on any other.
+//
+// For an uncompressed payload the blocks follow as little-endian 64-bit
+// words, bit i in word i / 64 at position i % 64, bits past bit_count zero.
+// The header is a whole cache line, so the blocks of a mapped file start
+// cache-line aligned.
+struct BitArrayFileHeader {
+    static const uint32_t CURRENT_VERSION = 1;
+
+    char magic[8];         // "BITARRAY"
+    uint32_t version;      // CURRENT_VERSION
+    uint32_t header_size;  // sizeof(BitArrayFileHeader)
+    uint64_t bit_count;    // Number of bits stored
+    uint32_t flags;        // Payload encoding, see BitArrayFileFlags
+    uint32_t reserved;
+    uint64_t payload_size; // Payload size in bytes
+    char padding[24];
+};
+
+static_assert(sizeof(BitArrayFileHeader) == 64, "BitArrayFileHeader must be one cache line");
+
+enum BitArrayFileFlags : uint32_t {
+    BITARRAY_RAW = 0,       // Plain blocks
+    BITARRAY_RLE = 1u << 0, // Run-length encoded blocks, see below
+};
+
+// Run-length encoded payload: a sequence of records, each starting with a
+// tag byte and a LEB128 block count:
+//   RLE_ZEROS n  - n blocks of all zeros
+//   RLE_ONES n   - n blocks of all ones
+//   RLE_WORDS n  - n literal blocks follow, 8 little-endian bytes each
+enum BitArrayRleTag : uint8_t {
+    RLE_ZEROS = 0,
+    RLE_ONES = 1,
+    RLE_WORDS = 2,
+};
+
+// Magic bytes opening every stored bit array
+inline const char BITARRAY_MAGIC[8] = {'B', 'I', 'T', 'A', 'R', 'R', 'A', 'Y'};
+
+#endif // BITARRAYFORMAT_H
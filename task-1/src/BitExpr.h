@@ -0,0 +1,152 @@
+#ifndef BITEXPR_H
+#define BITEXPR_H
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+class BitArray;
+
+// Lazy bitwise expressions over bit arrays.
+//
+// a & b, a | b, a ^ b and ~a do not compute anything by themselves: they
+// build a small expression object, and the whole tree is evaluated block by
+// block when it is assigned to a BitArray. So (a & b) | ~c runs one loop
+// over memory and creates no temporary arrays.
+//
+// Expressions keep references to the arrays they were built from, so they
+// must be used within the full expression (do not store them in auto).
+//
+// Every expression provides:
+//   size_t bit_count() const;         - number of bits
+//   unsigned long block(size_t i) const; - i-th block of the result,
+//                                        bits past bit_count() are unspecified
+template <class E>
+class BitExpr {
+public:
+    static const size_t BITS_PER_BLOCK = sizeof(unsigned long) * 8;
+
+    const E& self() const { return static_cast<const E&>(*this); }
+
+    size_t block_count() const {
+        return (self().bit_count() + BITS_PER_BLOCK - 1) / BITS_PER_BLOCK;
+    }
+
+    // Last block of the result with the bits past bit_count() cleared
+    unsigned long last_block() const {
+        size_t bits_in_last_block = self().bit_count() % BITS_PER_BLOCK;
+        unsigned long value = self().block(block_count() - 1);
+        if (bits_in_last_block > 0) {
+            value &= (1UL << bits_in_last_block) - 1;
+        }
+        return value;
+    }
+
+    // Counts true bits of the result without materializing it
+    size_t count() const {
+        size_t blocks = block_count();
+        if (blocks == 0) {
+            return 0;
+        }
+        size_t total = 0;
+        for (size_t i = 0; i + 1 < blocks; ++i) {
+            total += static_cast<size_t>(__builtin_popcountl(self().block(i)));
+        }
+        return total + static_cast<size_t>(__builtin_popcountl(last_block()));
+    }
+
+    // Returns true if the result has at least one true bit
+    bool any() const {
+        size_t blocks = block_count();
+        if (blocks == 0) {
+            return false;
+        }
+        for (size_t i = 0; i + 1 < blocks; ++i) {
+            if (self().block(i) != 0) {
+                return true;
+            }
+        }
+        return last_block() != 0;
+    }
+
+    // Returns true if all bits of the result are false
+    bool none() const { return !any(); }
+};
+
+// Arrays are held by reference, intermediate expressions by value
+template <class E>
+struct BitExprOperand {
+    using type = typename std::conditional<std::is_same<E, BitArray>::value, const E&, const E>::type;
+};
+
+struct BitAndOp {
+    static unsigned long apply(unsigned long a, unsigned long b) { return a & b; }
+    static const char* name() { return "AND"; }
+};
+
+struct BitOrOp {
+    static unsigned long apply(unsigned long a, unsigned long b) { return a | b; }
+    static const char* name() { return "OR"; }
+};
+
+struct BitXorOp {
+    static unsigned long apply(unsigned long a, unsigned long b) { return a ^ b; }
+    static const char* name() { return "XOR"; }
+};
+
+// Binary operation of two expressions of the same size
+template <class L, class R, class Op>
+class BitBinaryExpr : public BitExpr<BitBinaryExpr<L, R, Op>> {
+private:
+    typename BitExprOperand<L>::type m_left;
+    typename BitExprOperand<R>::type m_right;
+
+public:
+    BitBinaryExpr(const L& left, const R& right) : m_left(left), m_right(right) {
+        if (left.bit_count() != right.bit_count()) {
+            throw std::invalid_argument(std::string("Bit arrays must be of same size for ")
+                                        + Op::name() + " operation");
+        }
+    }
+
+    size_t bit_count() const { return m_left.bit_count(); }
+    unsigned long block(size_t i) const { return Op::apply(m_left.block(i), m_right.block(i)); }
+};
+
+// Bitwise inversion of an expression
+template <class E>
+class BitNotExpr : public BitExpr<BitNotExpr<E>> {
+private:
+    typename BitExprOperand<E>::type m_operand;
+
+public:
+    explicit BitNotExpr(const E& operand) : m_operand(operand) {}
+
+    size_t bit_count() const { return m_operand.bit_count(); }
+    unsigned long block(size_t i) const { return ~m_operand.block(i); }
+};
+
+// Bitwise operators
+template <class L, class R>
+BitBinaryExpr<L, R, BitAndOp> operator&(const BitExpr<L>& b1, const BitExpr<R>& b2) {
+    return BitBinaryExpr<L, R, BitAndOp>(b1.self(), b2.self());
+}
+
+template <class L, class R>
+BitBinaryExpr<L, R, BitOrOp> operator|(const BitExpr<L>& b1, const BitExpr<R>& b2) {
+    return BitBinaryExpr<L, R, BitOrOp>(b1.self(), b2.self());
+}
+
+template <class L, class R>
+BitBinaryExpr<L, R, BitXorOp> operator^(const BitExpr<L>& b1, const BitExpr<R>& b2) {
+    return BitBinaryExpr<L, R, BitXorOp>(b1.self(), b2.self());
+}
+
+// Bitwise inversion
+template <class E>
+BitNotExpr<E> operator~(const BitExpr<E>& b) {
+    return BitNotExpr<E>(b.self());
+}
+
+#endif // BITEXPR_H
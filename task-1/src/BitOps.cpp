@@ -0,0 +1,113 @@
+#include "BitOps.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define BITOPS_X86 1
+#include <immintrin.h>
+#endif
+
+namespace bitops {
+
+namespace {
+
+using PopcountFn = size_t (*)(const unsigned long*, size_t);
+
+// Portable version, the compiler emits its own bit tricks
+size_t popcount_generic(const unsigned long* blocks, size_t block_count) {
+    size_t total = 0;
+    for (size_t i = 0; i < block_count; ++i) {
+        total += static_cast<size_t>(__builtin_popcountl(blocks[i]));
+    }
+    return total;
+}
+
+#ifdef BITOPS_X86
+
+// Same loop, compiled to the POPCNT instruction
+__attribute__((target("popcnt")))
+size_t popcount_hw(const unsigned long* blocks, size_t block_count) {
+    size_t total = 0;
+    for (size_t i = 0; i < block_count; ++i) {
+        total += static_cast<size_t>(__builtin_popcountl(blocks[i]));
+    }
+    return total;
+}
+
+// Nibble lookup through VPSHUFB, byte sums folded with VPSADBW
+__attribute__((target("avx2,popcnt")))
+size_t popcount_avx2(const unsigned long* blocks, size_t block_count) {
+    const __m256i lookup = _mm256_setr_epi8(
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_mask = _mm256_set1_epi8(0x0f);
+    __m256i acc = _mm256_setzero_si256();
+    
+    size_t i = 0;
+    for (; i + 4 <= block_count; i += 4) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(blocks + i));
+        __m256i lo = _mm256_and_si256(v, low_mask);
+        __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+        __m256i bytes = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo),
+                                        _mm256_shuffle_epi8(lookup, hi));
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(bytes, _mm256_setzero_si256()));
+    }
+    
+    size_t total = static_cast<size_t>(_mm256_extract_epi64(acc, 0))
+                 + static_cast<size_t>(_mm256_extract_epi64(acc, 1))
+                 + static_cast<size_t>(_mm256_extract_epi64(acc, 2))
+                 + static_cast<size_t>(_mm256_extract_epi64(acc, 3));
+    for (; i < block_count; ++i) {
+        total += static_cast<size_t>(__builtin_popcountl(blocks[i]));
+    }
+    return total;
+}
+
+// Eight blocks per VPOPCNTQ, the tail goes through a masked load
+__attribute__((target("avx512f,avx512vpopcntdq")))
+size_t popcount_avx512(const unsigned long* blocks, size_t block_count) {
+    __m512i acc = _mm512_setzero_si512();
+    
+    size_t i = 0;
+    for (; i + 8 <= block_count; i += 8) {
+        __m512i v = _mm512_loadu_si512(blocks + i);
+        acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(v));
+    }
+    if (i < block_count) {
+        __mmask8 tail = static_cast<__mmask8>((1u << (block_count - i)) - 1);
+        __m512i v = _mm512_maskz_loadu_epi64(tail, blocks + i);
+        acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(v));
+    }
+    alignas(64) unsigned long long lanes[8];
+    _mm512_store_si512(lanes, acc);
+    size_t total = 0;
+    for (unsigned long long lane : lanes) {
+        total += static_cast<size_t>(lane);
+    }
+    return total;
+}
+
+#endif // BITOPS_X86
+
+PopcountFn select_popcount() {
+#ifdef BITOPS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512vpopcntdq") && __builtin_cpu_supports("avx512f")) {
+        return popcount_avx512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt")) {
+        return popcount_avx2;
+    }
+    if (__builtin_cpu_supports("popcnt")) {
+        return popcount_hw;
+    }
+#endif
+    return popcount_generic;
+}
+
+} // namespace
+
+size_t popcount(const unsigned long* blocks, size_t block_count) {
+    static const PopcountFn impl = select_popcount();
+    return impl(blocks, block_count);
+}
+
+} // namespace bitops
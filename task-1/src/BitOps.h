@@ -0,0 +1,16 @@
+#ifndef BITOPS_H
+#define BITOPS_H
+
+#include <cstddef>
+
+// Low-level kernels over raw blocks of bits, shared by the bit array classes.
+namespace bitops {
+
+// Counts set bits in blocks[0..block_count).
+// Picks the widest popcount kernel the CPU supports (AVX-512 VPOPCNTDQ,
+// AVX2, hardware POPCNT or the portable fallback) on first call.
+size_t popcount(const unsigned long* blocks, size_t block_count);
+
+} // namespace bitops
+
+#endif // BITOPS_H
@@ -0,0 +1,613 @@
+#include "CompressedBitArray.h"
+#include "BitArray.h"
+#include <algorithm>
+#include <climits>
+#include <iterator>
+#include <stdexcept>
+
+static_assert(sizeof(unsigned long) == sizeof(uint64_t),
+              "BitArray blocks are expected to be 64-bit");
+
+namespace {
+
+const size_t WORD_BITS = 64;
+
+// Sets bits first..last (inclusive) in words
+void fill_range(uint64_t* words, size_t first, size_t last) {
+    size_t first_word = first / WORD_BITS;
+    size_t last_word = last / WORD_BITS;
+    uint64_t first_mask = ~0ULL << (first % WORD_BITS);
+    uint64_t last_mask = ~0ULL >> (WORD_BITS - 1 - last % WORD_BITS);
+
+    if (first_word == last_word) {
+        words[first_word] |= first_mask & last_mask;
+        return;
+    }
+    words[first_word] |= first_mask;
+    for (size_t i = first_word + 1; i < last_word; ++i) {
+        words[i] = ~0ULL;
+    }
+    words[last_word] |= last_mask;
+}
+
+// Index of the first set (or clear, if invert) bit at or after pos, or limit
+size_t next_bit(const uint64_t* words, size_t word_count, size_t pos, bool invert) {
+    size_t limit = word_count * WORD_BITS;
+    if (pos >= limit) {
+        return limit;
+    }
+
+    size_t i = pos / WORD_BITS;
+    uint64_t w = (invert ? ~words[i] : words[i]) & (~0ULL << (pos % WORD_BITS));
+    while (w == 0) {
+        if (++i == word_count) {
+            return limit;
+        }
+        w = invert ? ~words[i] : words[i];
+    }
+    return i * WORD_BITS + static_cast<size_t>(__builtin_ctzll(w));
+}
+
+} // namespace
+
+// Word and sorted-array forms of the binary operations
+struct CompressedBitArray::AndOp {
+    static constexpr bool KEEPS_UNMATCHED = false; // A chunk missing on one side gives nothing
+    static const char* name() { return "AND"; }
+    static uint64_t apply(uint64_t a, uint64_t b) { return a & b; }
+    static void merge_arrays(const std::vector<uint16_t>& a, const std::vector<uint16_t>& b,
+                             std::vector<uint16_t>& out) {
+        std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(out));
+    }
+};
+
+struct CompressedBitArray::OrOp {
+    static constexpr bool KEEPS_UNMATCHED = true;
+    static const char* name() { return "OR"; }
+    static uint64_t apply(uint64_t a, uint64_t b) { return a | b; }
+    static void merge_arrays(const std::vector<uint16_t>& a, const std::vector<uint16_t>& b,
+                             std::vector<uint16_t>& out) {
+        std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(out));
+    }
+};
+
+struct CompressedBitArray::XorOp {
+    static constexpr bool KEEPS_UNMATCHED = true;
+    static const char* name() { return "XOR"; }
+    static uint64_t apply(uint64_t a, uint64_t b) { return a ^ b; }
+    static void merge_arrays(const std::vector<uint16_t>& a, const std::vector<uint16_t>& b,
+                             std::vector<uint16_t>& out) {
+        std::set_symmetric_difference(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(out));
+    }
+};
+
+// ---- Container ----
+
+bool CompressedBitArray::Container::contains(uint16_t low) const {
+    switch (kind) {
+    case Kind::Array:
+        return std::binary_search(values.begin(), values.end(), low);
+    case Kind::Bitset:
+        return (words[low / WORD_BITS] >> (low % WORD_BITS)) & 1;
+    case Kind::Run: {
+        // Last run starting at or before low
+        auto it = std::upper_bound(runs.begin(), runs.end(), low,
+                                   [](uint16_t v, const Run& r) { return v < r.start; });
+        return it != runs.begin() && std::prev(it)->last >= low;
+    }
+    }
+    return false;
+}
+
+// Writes the chunk as CHUNK_WORDS plain words
+void CompressedBitArray::Container::to_words(uint64_t* out) const {
+    if (kind == Kind::Bitset) {
+        std::copy(words.begin(), words.end(), out);
+        return;
+    }
+
+    std::fill(out, out + CHUNK_WORDS, 0ULL);
+    if (kind == Kind::Array) {
+        for (uint16_t v : values) {
+            out[v / WORD_BITS] |= 1ULL << (v % WORD_BITS);
+        }
+    } else {
+        for (const Run& r : runs) {
+            fill_range(out, r.start, r.last);
+        }
+    }
+}
+
+// Builds the smallest container for CHUNK_WORDS words
+CompressedBitArray::Container CompressedBitArray::Container::from_words(const uint64_t* src) {
+    Container c;
+
+    // Cardinality and number of runs (a run starts at a one preceded by a zero)
+    size_t card = 0;
+    size_t run_count = 0;
+    uint64_t carry = 0;
+    for (size_t i = 0; i < CHUNK_WORDS; ++i) {
+        uint64_t w = src[i];
+        card += static_cast<size_t>(__builtin_popcountll(w));
+        run_count += static_cast<size_t>(__builtin_popcountll(w & ~((w << 1) | carry)));
+        carry = w >> (WORD_BITS - 1);
+    }
+
+    c.cardinality = static_cast<uint32_t>(card);
+    if (card == 0) {
+        return c;
+    }
+
+    size_t bitset_bytes = CHUNK_WORDS * sizeof(uint64_t);
+    size_t array_bytes = card <= ARRAY_MAX ? card * sizeof(uint16_t) : bitset_bytes + 1;
+    size_t run_bytes = run_count * sizeof(Run);
+
+    if (run_bytes < std::min(array_bytes, bitset_bytes)) {
+        c.kind = Kind::Run;
+        c.runs.reserve(run_count);
+        size_t pos = next_bit(src, CHUNK_WORDS, 0, false);
+        while (pos < CHUNK_BITS) {
+            size_t end = next_bit(src, CHUNK_WORDS, pos, true);
+            c.runs.push_back({static_cast<uint16_t>(pos), static_cast<uint16_t>(end - 1)});
+            pos = next_bit(src, CHUNK_WORDS, end, false);
+        }
+    } else if (card <= ARRAY_MAX) {
+        c.kind = Kind::Array;
+        c.values.reserve(card);
+        for (size_t i = 0; i < CHUNK_WORDS; ++i) {
+            for (uint64_t w = src[i]; w != 0; w &= w - 1) {
+                c.values.push_back(static_cast<uint16_t>(i * WORD_BITS + __builtin_ctzll(w)));
+            }
+        }
+    } else {
+        c.kind = Kind::Bitset;
+        c.words.assign(src, src + CHUNK_WORDS);
+    }
+    return c;
+}
+
+// Turns a run container into an array or bitset before modification
+void CompressedBitArray::Container::make_mutable() {
+    if (kind != Kind::Run) {
+        return;
+    }
+
+    std::vector<uint64_t> plain(CHUNK_WORDS);
+    to_words(plain.data());
+    runs.clear();
+    runs.shrink_to_fit();
+
+    if (cardinality <= ARRAY_MAX) {
+        kind = Kind::Array;
+        values.reserve(cardinality);
+        for (size_t i = 0; i < CHUNK_WORDS; ++i) {
+            for (uint64_t w = plain[i]; w != 0; w &= w - 1) {
+                values.push_back(static_cast<uint16_t>(i * WORD_BITS + __builtin_ctzll(w)));
+            }
+        }
+    } else {
+        kind = Kind::Bitset;
+        words = std::move(plain);
+    }
+}
+
+void CompressedBitArray::Container::add(uint16_t low) {
+    make_mutable();
+
+    if (kind == Kind::Array) {
+        auto it = std::lower_bound(values.begin(), values.end(), low);
+        if (it != values.end() && *it == low) {
+            return;
+        }
+        values.insert(it, low);
+        ++cardinality;
+
+        // Too many values for an array: switch to a bitset
+        if (cardinality > ARRAY_MAX) {
+            words.assign(CHUNK_WORDS, 0ULL);
+            for (uint16_t v : values) {
+                words[v / WORD_BITS] |= 1ULL << (v % WORD_BITS);
+            }
+            values.clear();
+            values.shrink_to_fit();
+            kind = Kind::Bitset;
+        }
+    } else {
+        uint64_t mask = 1ULL << (low % WORD_BITS);
+        if ((words[low / WORD_BITS] & mask) == 0) {
+            words[low / WORD_BITS] |= mask;
+            ++cardinality;
+        }
+    }
+}
+
+void CompressedBitArray::Container::remove(uint16_t low) {
+    make_mutable();
+
+    if (kind == Kind::Array) {
+        auto it = std::lower_bound(values.begin(), values.end(), low);
+        if (it != values.end() && *it == low) {
+            values.erase(it);
+            --cardinality;
+        }
+    } else {
+        uint64_t mask = 1ULL << (low % WORD_BITS);
+        if ((words[low / WORD_BITS] & mask) != 0) {
+            words[low / WORD_BITS] &= ~mask;
+            --cardinality;
+        }
+
+        // Sparse enough for an array again
+        if (cardinality <= ARRAY_MAX) {
+            for (size_t i = 0; i < CHUNK_WORDS; ++i) {
+                for (uint64_t w = words[i]; w != 0; w &= w - 1) {
+                    values.push_back(static_cast<uint16_t>(i * WORD_BITS + __builtin_ctzll(w)));
+                }
+            }
+            words.clear();
+            words.shrink_to_fit();
+            kind = Kind::Array;
+        }
+    }
+}
+
+size_t CompressedBitArray::Container::memory_usage() const {
+    return sizeof(Container)
+         + values.capacity() * sizeof(uint16_t)
+         + words.capacity() * sizeof(uint64_t)
+         + runs.capacity() * sizeof(Run);
+}
+
+// ---- CompressedBitArray ----
+
+// Constructs an empty bit array
+CompressedBitArray::CompressedBitArray() : m_bit_count(0) {}
+
+// Constructs an array of num_bits false bits
+CompressedBitArray::CompressedBitArray(size_t num_bits) : m_bit_count(num_bits) {}
+
+// Compresses a dense bit array chunk by chunk
+CompressedBitArray::CompressedBitArray(const BitArray& bits)
+    : m_bit_count(static_cast<size_t>(bits.size())) {
+    const unsigned long* data = bits.data();
+    size_t blocks = (m_bit_count + WORD_BITS - 1) / WORD_BITS;
+    std::vector<uint64_t> words(CHUNK_WORDS);
+
+    for (size_t key = 0; key < chunk_count(); ++key) {
+        size_t first = key * CHUNK_WORDS;
+        size_t n = std::min(CHUNK_WORDS, blocks - first);
+        std::fill(words.begin(), words.end(), 0ULL);
+        std::copy(data + first, data + first + n, words.begin());
+
+        Container c = Container::from_words(words.data());
+        if (c.cardinality > 0) {
+            m_keys.push_back(key);
+            m_containers.push_back(std::move(c));
+        }
+    }
+}
+
+// Expands into a dense bit array
+BitArray CompressedBitArray::to_bit_array() const {
+    if (m_bit_count > static_cast<size_t>(INT_MAX)) {
+        throw std::length_error("CompressedBitArray is too large for BitArray");
+    }
+
+    // Chunks are expanded straight into the blocks of the result; the last
+    // chunk holds no bits past m_bit_count, so the tail stays zero
+    BitArray result(static_cast<int>(m_bit_count));
+    unsigned long* data = result.data();
+    size_t blocks = (m_bit_count + WORD_BITS - 1) / WORD_BITS;
+    std::vector<uint64_t> words(CHUNK_WORDS);
+    for (size_t i = 0; i < m_keys.size(); ++i) {
+        size_t first = m_keys[i] * CHUNK_WORDS;
+        size_t n = std::min(CHUNK_WORDS, blocks - first);
+        m_containers[i].to_words(words.data());
+        std::copy(words.begin(), words.begin() + n, data + first);
+    }
+    return result;
+}
+
+// Number of valid bits in chunk key
+size_t CompressedBitArray::chunk_size(size_t key) const {
+    return std::min(CHUNK_BITS, m_bit_count - key * CHUNK_BITS);
+}
+
+// Position of key in m_keys, or of the place where it would be inserted
+size_t CompressedBitArray::key_position(size_t key) const {
+    return static_cast<size_t>(std::lower_bound(m_keys.begin(), m_keys.end(), key) - m_keys.begin());
+}
+
+void CompressedBitArray::check_index(size_t n) const {
+    if (n >= m_bit_count) {
+        throw std::out_of_range("Bit index out of range");
+    }
+}
+
+// Sets bit at index n to value val
+CompressedBitArray& CompressedBitArray::set(size_t n, bool val) {
+    check_index(n);
+
+    size_t key = n / CHUNK_BITS;
+    uint16_t low = static_cast<uint16_t>(n % CHUNK_BITS);
+    size_t pos = key_position(key);
+    bool found = pos < m_keys.size() && m_keys[pos] == key;
+
+    if (val) {
+        if (!found) {
+            m_keys.insert(m_keys.begin() + pos, key);
+            m_containers.insert(m_containers.begin() + pos, Container());
+        }
+        m_containers[pos].add(low);
+    } else if (found) {
+        m_containers[pos].remove(low);
+        // Empty chunks are not stored
+        if (m_containers[pos].cardinality == 0) {
+            m_keys.erase(m_keys.begin() + pos);
+            m_containers.erase(m_containers.begin() + pos);
+        }
+    }
+    return *this;
+}
+
+// Sets all bits to true
+CompressedBitArray& CompressedBitArray::set() {
+    m_keys.clear();
+    m_containers.clear();
+
+    for (size_t key = 0; key < chunk_count(); ++key) {
+        Container c;
+        c.kind = Kind::Run;
+        c.cardinality = static_cast<uint32_t>(chunk_size(key));
+        c.runs.push_back({0, static_cast<uint16_t>(chunk_size(key) - 1)});
+        m_keys.push_back(key);
+        m_containers.push_back(std::move(c));
+    }
+    return *this;
+}
+
+// Sets bit at index n to false
+CompressedBitArray& CompressedBitArray::reset(size_t n) {
+    return set(n, false);
+}
+
+// Sets all bits to false
+CompressedBitArray& CompressedBitArray::reset() {
+    m_keys.clear();
+    m_containers.clear();
+    return *this;
+}
+
+// Returns value of bit at index n
+bool CompressedBitArray::operator[](size_t n) const {
+    check_index(n);
+
+    size_t key = n / CHUNK_BITS;
+    size_t pos = key_position(key);
+    if (pos == m_keys.size() || m_keys[pos] != key) {
+        return false;
+    }
+    return m_containers[pos].contains(static_cast<uint16_t>(n % CHUNK_BITS));
+}
+
+// Returns true if array contains at least one true bit (stored chunks are never empty)
+bool CompressedBitArray::any() const {
+    return !m_keys.empty();
+}
+
+// Returns true if all bits are false
+bool CompressedBitArray::none() const {
+    return !any();
+}
+
+// Counts number of true bits
+size_t CompressedBitArray::count() const {
+    size_t total = 0;
+    for (const Container& c : m_containers) {
+        total += c.cardinality;
+    }
+    return total;
+}
+
+// Merges chunk lists of a and b with operation Op
+template <class Op>
+CompressedBitArray CompressedBitArray::combine(const CompressedBitArray& a, const CompressedBitArray& b) {
+    if (a.m_bit_count != b.m_bit_count) {
+        throw std::invalid_argument(std::string("Bit arrays must be of same size for ")
+                                    + Op::name() + " operation");
+    }
+
+    CompressedBitArray result(a.m_bit_count);
+    std::vector<uint64_t> left(CHUNK_WORDS);
+    std::vector<uint64_t> right(CHUNK_WORDS);
+    size_t i = 0;
+    size_t j = 0;
+
+    while (i < a.m_keys.size() || j < b.m_keys.size()) {
+        // Chunk present only in a
+        if (j == b.m_keys.size() || (i < a.m_keys.size() && a.m_keys[i] < b.m_keys[j])) {
+            if (Op::KEEPS_UNMATCHED) {
+                result.m_keys.push_back(a.m_keys[i]);
+                result.m_containers.push_back(a.m_containers[i]);
+            }
+            ++i;
+            continue;
+        }
+
+        // Chunk present only in b
+        if (i == a.m_keys.size() || b.m_keys[j] < a.m_keys[i]) {
+            if (Op::KEEPS_UNMATCHED) {
+                result.m_keys.push_back(b.m_keys[j]);
+                result.m_containers.push_back(b.m_containers[j]);
+            }
+            ++j;
+            continue;
+        }
+
+        // Chunk in both: two arrays merge as sorted lists, anything else as words
+        const Container& ca = a.m_containers[i];
+        const Container& cb = b.m_containers[j];
+        Container merged;
+
+        if (ca.kind == Kind::Array && cb.kind == Kind::Array) {
+            Op::merge_arrays(ca.values, cb.values, merged.values);
+            merged.cardinality = static_cast<uint32_t>(merged.values.size());
+            if (merged.cardinality > ARRAY_MAX) {
+                std::fill(left.begin(), left.end(), 0ULL);
+                for (uint16_t v : merged.values) {
+                    left[v / WORD_BITS] |= 1ULL << (v % WORD_BITS);
+                }
+                merged = Container::from_words(left.data());
+            }
+        } else {
+            ca.to_words(left.data());
+            cb.to_words(right.data());
+            for (size_t w = 0; w < CHUNK_WORDS; ++w) {
+                left[w] = Op::apply(left[w], right[w]);
+            }
+            merged = Container::from_words(left.data());
+        }
+
+        if (merged.cardinality > 0) {
+            result.m_keys.push_back(a.m_keys[i]);
+            result.m_containers.push_back(std::move(merged));
+        }
+        ++i;
+        ++j;
+    }
+    return result;
+}
+
+// Bitwise AND operation
+CompressedBitArray& CompressedBitArray::operator&=(const CompressedBitArray& other) {
+    *this = combine<AndOp>(*this, other);
+    return *this;
+}
+
+// Bitwise OR operation
+CompressedBitArray& CompressedBitArray::operator|=(const CompressedBitArray& other) {
+    *this = combine<OrOp>(*this, other);
+    return *this;
+}
+
+// Bitwise XOR operation
+CompressedBitArray& CompressedBitArray::operator^=(const CompressedBitArray& other) {
+    *this = combine<XorOp>(*this, other);
+    return *this;
+}
+
+// Bitwise inversion: missing chunks become full runs, stored ones are complemented
+CompressedBitArray CompressedBitArray::operator~() const {
+    CompressedBitArray result(m_bit_count);
+    std::vector<uint64_t> words(CHUNK_WORDS);
+    size_t pos = 0;
+
+    for (size_t key = 0; key < chunk_count(); ++key) {
+        size_t bits = chunk_size(key);
+
+        if (pos == m_keys.size() || m_keys[pos] != key) {
+            Container full;
+            full.kind = Kind::Run;
+            full.cardinality = static_cast<uint32_t>(bits);
+            full.runs.push_back({0, static_cast<uint16_t>(bits - 1)});
+            result.m_keys.push_back(key);
+            result.m_containers.push_back(std::move(full));
+            continue;
+        }
+
+        m_containers[pos++].to_words(words.data());
+        for (uint64_t& w : words) {
+            w = ~w;
+        }
+
+        // The last chunk may be shorter than CHUNK_BITS
+        if (bits < CHUNK_BITS) {
+            std::fill(words.begin() + (bits + WORD_BITS - 1) / WORD_BITS, words.end(), 0ULL);
+            if (bits % WORD_BITS != 0) {
+                words[bits / WORD_BITS] &= (1ULL << (bits % WORD_BITS)) - 1;
+            }
+        }
+
+        Container c = Container::from_words(words.data());
+        if (c.cardinality > 0) {
+            result.m_keys.push_back(key);
+            result.m_containers.push_back(std::move(c));
+        }
+    }
+    return result;
+}
+
+// Re-picks the smallest container for every chunk
+void CompressedBitArray::optimize() {
+    std::vector<uint64_t> words(CHUNK_WORDS);
+    for (Container& c : m_containers) {
+        c.to_words(words.data());
+        c = Container::from_words(words.data());
+    }
+}
+
+// Returns approximate number of bytes used by the chunk containers
+size_t CompressedBitArray::memory_usage() const {
+    size_t total = m_keys.capacity() * sizeof(size_t);
+    for (const Container& c : m_containers) {
+        total += c.memory_usage();
+    }
+    return total;
+}
+
+// Returns string representation of array
+std::string CompressedBitArray::to_string() const {
+    std::string result(m_bit_count, '0');
+    std::vector<uint64_t> words(CHUNK_WORDS);
+    for (size_t i = 0; i < m_keys.size(); ++i) {
+        size_t base = m_keys[i] * CHUNK_BITS;
+        m_containers[i].to_words(words.data());
+        for (size_t w = 0; w < CHUNK_WORDS; ++w) {
+            for (uint64_t bits = words[w]; bits != 0; bits &= bits - 1) {
+                result[base + w * WORD_BITS + __builtin_ctzll(bits)] = '1';
+            }
+        }
+    }
+    return result;
+}
+
+// Comparison operators. The same chunk may sit in different containers,
+// so contents are compared as words.
+bool operator==(const CompressedBitArray& a, const CompressedBitArray& b) {
+    if (a.m_bit_count != b.m_bit_count || a.m_keys != b.m_keys) {
+        return false;
+    }
+
+    std::vector<uint64_t> left(CompressedBitArray::CHUNK_WORDS);
+    std::vector<uint64_t> right(CompressedBitArray::CHUNK_WORDS);
+    for (size_t i = 0; i < a.m_containers.size(); ++i) {
+        if (a.m_containers[i].cardinality != b.m_containers[i].cardinality) {
+            return false;
+        }
+        a.m_containers[i].to_words(left.data());
+        b.m_containers[i].to_words(right.data());
+        if (left != right) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool operator!=(const CompressedBitArray& a, const CompressedBitArray& b) {
+    return !(a == b);
+}
+
+// Bitwise AND
+CompressedBitArray operator&(const CompressedBitArray& b1, const CompressedBitArray& b2) {
+    return CompressedBitArray::combine<CompressedBitArray::AndOp>(b1, b2);
+}
+
+// Bitwise OR
+CompressedBitArray operator|(const CompressedBitArray& b1, const CompressedBitArray& b2) {
+    return CompressedBitArray::combine<CompressedBitArray::OrOp>(b1, b2);
+}
+
+// Bitwise XOR
+CompressedBitArray operator^(const CompressedBitArray& b1, const CompressedBitArray& b2) {
+    return CompressedBitArray::combine<CompressedBitArray::XorOp>(b1, b2);
+}
@@ -0,0 +1,160 @@
+#ifndef COMPRESSEDBITARRAY_H
+#define COMPRESSEDBITARRAY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class BitArray;
+
+// Compressed bit array for sparse or clustered data (Roaring-style).
+//
+// The index range is split into chunks of 65536 bits. Chunks without true
+// bits take no memory; every other chunk is stored in whichever container
+// is smallest for its contents:
+//   array  - sorted list of 16-bit positions, for up to 4096 true bits
+//   bitset - plain 8 KiB bitmap, for dense chunks
+//   run    - list of [start, last] intervals, for long stretches of ones
+//
+// The interface mirrors BitArray, with size_t indices so that arrays of
+// 2^32 and more bits can be addressed.
+class CompressedBitArray {
+private:
+    static constexpr size_t CHUNK_BITS = 65536;
+    static constexpr size_t CHUNK_WORDS = CHUNK_BITS / 64;
+    static constexpr size_t ARRAY_MAX = 4096; // Largest array container
+
+    enum class Kind { Array, Bitset, Run };
+
+    // Inclusive interval of true bits inside a chunk
+    struct Run {
+        uint16_t start;
+        uint16_t last;
+    };
+
+    // Contents of one non-empty chunk
+    struct Container {
+        Kind kind = Kind::Array;
+        uint32_t cardinality = 0;
+        std::vector<uint16_t> values; // Array: sorted positions
+        std::vector<uint64_t> words;  // Bitset: CHUNK_WORDS words
+        std::vector<Run> runs;        // Run: sorted, non-adjacent intervals
+
+        bool contains(uint16_t low) const;
+
+        // Writes the chunk as CHUNK_WORDS plain words
+        void to_words(uint64_t* out) const;
+
+        // Builds the smallest container for CHUNK_WORDS words (cardinality 0 if empty)
+        static Container from_words(const uint64_t* words);
+
+        // Turns a run container into an array or bitset before modification
+        void make_mutable();
+
+        void add(uint16_t low);
+        void remove(uint16_t low);
+
+        size_t memory_usage() const;
+    };
+
+    // Operations used by combine(): word form and sorted array form
+    struct AndOp;
+    struct OrOp;
+    struct XorOp;
+
+    size_t m_bit_count;
+    std::vector<size_t> m_keys;           // Sorted chunk numbers (index / CHUNK_BITS)
+    std::vector<Container> m_containers;  // Parallel to m_keys
+
+    size_t chunk_count() const { return (m_bit_count + CHUNK_BITS - 1) / CHUNK_BITS; }
+
+    // Number of valid bits in chunk key (only the last chunk can be shorter)
+    size_t chunk_size(size_t key) const;
+
+    // Position of key in m_keys, or of the place where it would be inserted
+    size_t key_position(size_t key) const;
+
+    void check_index(size_t n) const;
+
+    template <class Op>
+    static CompressedBitArray combine(const CompressedBitArray& a, const CompressedBitArray& b);
+
+public:
+    // Constructs an empty bit array
+    CompressedBitArray();
+
+    // Constructs an array of num_bits false bits
+    explicit CompressedBitArray(size_t num_bits);
+
+    // Compresses a dense bit array
+    explicit CompressedBitArray(const BitArray& bits);
+
+    // Expands into a dense bit array. Throws std::length_error if the size
+    // does not fit BitArray.
+    BitArray to_bit_array() const;
+
+    // Sets bit at index n to value val
+    CompressedBitArray& set(size_t n, bool val = true);
+
+    // Sets all bits to true (one run per chunk)
+    CompressedBitArray& set();
+
+    // Sets bit at index n to false
+    CompressedBitArray& reset(size_t n);
+
+    // Sets all bits to false, freeing all chunks
+    CompressedBitArray& reset();
+
+    // Returns value of bit at index n
+    bool operator[](size_t n) const;
+
+    // Returns true if array contains at least one true bit
+    bool any() const;
+
+    // Returns true if all bits are false
+    bool none() const;
+
+    // Counts number of true bits
+    size_t count() const;
+
+    // Returns size of array in bits
+    size_t size() const { return m_bit_count; }
+
+    // Returns true if array is empty
+    bool empty() const { return m_bit_count == 0; }
+
+    // Bitwise operations on arrays. Work only on arrays of same size.
+    CompressedBitArray& operator&=(const CompressedBitArray& other);
+    CompressedBitArray& operator|=(const CompressedBitArray& other);
+    CompressedBitArray& operator^=(const CompressedBitArray& other);
+
+    // Bitwise inversion
+    CompressedBitArray operator~() const;
+
+    // Re-picks the smallest container for every chunk. Single-bit updates
+    // never create run containers, so call this after bulk modifications.
+    void optimize();
+
+    // Returns approximate number of bytes used by the chunk containers
+    size_t memory_usage() const;
+
+    // Returns string representation of array
+    std::string to_string() const;
+
+    friend bool operator==(const CompressedBitArray& a, const CompressedBitArray& b);
+    friend CompressedBitArray operator&(const CompressedBitArray& b1, const CompressedBitArray& b2);
+    friend CompressedBitArray operator|(const CompressedBitArray& b1, const CompressedBitArray& b2);
+    friend CompressedBitArray operator^(const CompressedBitArray& b1, const CompressedBitArray& b2);
+};
+
+// Comparison operators
+bool operator==(const CompressedBitArray& a, const CompressedBitArray& b);
+bool operator!=(const CompressedBitArray& a, const CompressedBitArray& b);
+
+// Bitwise operators
+CompressedBitArray operator&(const CompressedBitArray& b1, const CompressedBitArray& b2);
+CompressedBitArray operator|(const CompressedBitArray& b1, const CompressedBitArray& b2);
+CompressedBitArray operator^(const CompressedBitArray& b1, const CompressedBitArray& b2);
+
+#endif // COMPRESSEDBITARRAY_H
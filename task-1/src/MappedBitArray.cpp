@@ -0,0 +1,292 @@
+#include "MappedBitArray.h"
+#include "BitArray.h"
+#include "BitArrayFormat.h"
+#include "BitOps.h"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "MappedBitArray maps little-endian blocks directly and needs a little-endian host"
+#endif
+
+namespace {
+
+std::runtime_error file_error(const std::string& what, const std::string& path) {
+    return std::runtime_error(what + ": " + path + " (" + std::strerror(errno) + ")");
+}
+
+size_t payload_bytes(size_t num_bits) {
+    return (num_bits + 63) / 64 * sizeof(uint64_t);
+}
+
+} // namespace
+
+MappedBitArray::MappedBitArray()
+    : m_fd(-1), m_mapping(nullptr), m_mapping_size(0), m_blocks(nullptr),
+      m_bit_count(0), m_mode(Mode::ReadWrite) {}
+
+// Maps an existing file
+MappedBitArray::MappedBitArray(const std::string& path, Mode mode) : MappedBitArray() {
+    m_mode = mode;
+    m_fd = ::open(path.c_str(), mode == Mode::ReadOnly ? O_RDONLY : O_RDWR);
+    if (m_fd < 0) {
+        throw file_error("Cannot open file", path);
+    }
+
+    struct stat st;
+    if (::fstat(m_fd, &st) != 0) {
+        int saved = errno;
+        ::close(m_fd);
+        errno = saved;
+        throw file_error("Cannot stat file", path);
+    }
+
+    size_t file_size = static_cast<size_t>(st.st_size);
+    if (file_size < sizeof(BitArrayFileHeader)) {
+        ::close(m_fd);
+        throw std::runtime_error("Not a bit array file: " + path);
+    }
+
+    map(path, file_size);
+
+    BitArrayFileHeader header;
+    std::memcpy(&header, m_mapping, sizeof(header));
+    bool valid = std::memcmp(header.magic, BITARRAY_MAGIC, sizeof(header.magic)) == 0
+              && header.version == BitArrayFileHeader::CURRENT_VERSION
+              && header.header_size == sizeof(BitArrayFileHeader)
+              && header.bit_count <= (file_size - sizeof(header)) * 8
+              && header.payload_size == payload_bytes(static_cast<size_t>(header.bit_count));
+    if (!valid) {
+        unmap();
+        throw std::runtime_error("Not a bit array file: " + path);
+    }
+    if (header.flags != BITARRAY_RAW) {
+        unmap();
+        throw std::runtime_error("Compressed bit array files cannot be mapped: " + path);
+    }
+
+    m_bit_count = static_cast<size_t>(header.bit_count);
+}
+
+// Creates a file of num_bits false bits
+MappedBitArray MappedBitArray::create(const std::string& path, size_t num_bits) {
+    MappedBitArray result;
+    result.m_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (result.m_fd < 0) {
+        throw file_error("Cannot create file", path);
+    }
+
+    // A fresh file reads as zeros, only the header has to be written
+    size_t file_size = sizeof(BitArrayFileHeader) + payload_bytes(num_bits);
+    if (::ftruncate(result.m_fd, static_cast<off_t>(file_size)) != 0) {
+        int saved = errno;
+        ::close(result.m_fd);
+        result.m_fd = -1;
+        errno = saved;
+        throw file_error("Cannot resize file", path);
+    }
+
+    result.map(path, file_size);
+
+    BitArrayFileHeader header = {};
+    std::memcpy(header.magic, BITARRAY_MAGIC, sizeof(header.magic));
+    header.version = BitArrayFileHeader::CURRENT_VERSION;
+    header.header_size = sizeof(BitArrayFileHeader);
+    header.bit_count = num_bits;
+    header.flags = BITARRAY_RAW;
+    header.payload_size = payload_bytes(num_bits);
+    std::memcpy(result.m_mapping, &header, sizeof(header));
+
+    result.m_bit_count = num_bits;
+    return result;
+}
+
+// Creates a file with a copy of bits
+MappedBitArray MappedBitArray::create(const std::string& path, const BitArray& bits) {
+    MappedBitArray result = create(path, static_cast<size_t>(bits.size()));
+    if (bits.data() != nullptr) {
+        std::copy(bits.data(), bits.data() + result.used_blocks(), result.m_blocks);
+    }
+    return result;
+}
+
+MappedBitArray::~MappedBitArray() {
+    unmap();
+}
+
+MappedBitArray::MappedBitArray(MappedBitArray&& other) noexcept
+    : m_fd(other.m_fd), m_mapping(other.m_mapping), m_mapping_size(other.m_mapping_size),
+      m_blocks(other.m_blocks), m_bit_count(other.m_bit_count), m_mode(other.m_mode) {
+    other.m_fd = -1;
+    other.m_mapping = nullptr;
+    other.m_mapping_size = 0;
+    other.m_blocks = nullptr;
+    other.m_bit_count = 0;
+}
+
+MappedBitArray& MappedBitArray::operator=(MappedBitArray&& other) noexcept {
+    if (this != &other) {
+        unmap();
+        std::swap(m_fd, other.m_fd);
+        std::swap(m_mapping, other.m_mapping);
+        std::swap(m_mapping_size, other.m_mapping_size);
+        std::swap(m_blocks, other.m_blocks);
+        std::swap(m_bit_count, other.m_bit_count);
+        std::swap(m_mode, other.m_mode);
+    }
+    return *this;
+}
+
+// Maps the whole file, shared so that writes reach the page cache
+void MappedBitArray::map(const std::string& path, size_t file_size) {
+    int prot = m_mode == Mode::ReadOnly ? PROT_READ : PROT_READ | PROT_WRITE;
+    void* mapping = ::mmap(nullptr, file_size, prot, MAP_SHARED, m_fd, 0);
+    if (mapping == MAP_FAILED) {
+        int saved = errno;
+        ::close(m_fd);
+        m_fd = -1;
+        errno = saved;
+        throw file_error("Cannot map file", path);
+    }
+
+    m_mapping = static_cast<unsigned char*>(mapping);
+    m_mapping_size = file_size;
+    m_blocks = reinterpret_cast<unsigned long*>(m_mapping + sizeof(BitArrayFileHeader));
+}
+
+void MappedBitArray::unmap() {
+    if (m_mapping != nullptr) {
+        ::munmap(m_mapping, m_mapping_size);
+    }
+    if (m_fd >= 0) {
+        ::close(m_fd);
+    }
+    m_fd = -1;
+    m_mapping = nullptr;
+    m_mapping_size = 0;
+    m_blocks = nullptr;
+    m_bit_count = 0;
+}
+
+// Last block with bits past the size masked off
+unsigned long MappedBitArray::last_block() const {
+    unsigned long value = m_blocks[used_blocks() - 1];
+    size_t bits_in_last_block = m_bit_count % BITS_PER_BLOCK;
+    if (bits_in_last_block > 0) {
+        value &= (1UL << bits_in_last_block) - 1;
+    }
+    return value;
+}
+
+void MappedBitArray::check_index(size_t n) const {
+    if (n >= m_bit_count) {
+        throw std::out_of_range("Bit index out of range");
+    }
+}
+
+void MappedBitArray::check_writable() const {
+    if (m_mode != Mode::ReadWrite) {
+        throw std::logic_error("Bit array is mapped read-only");
+    }
+}
+
+// Sets bit at index n to value val
+MappedBitArray& MappedBitArray::set(size_t n, bool val) {
+    check_writable();
+    check_index(n);
+
+    unsigned long mask = 1UL << (n % BITS_PER_BLOCK);
+    if (val) {
+        m_blocks[n / BITS_PER_BLOCK] |= mask;
+    } else {
+        m_blocks[n / BITS_PER_BLOCK] &= ~mask;
+    }
+    return *this;
+}
+
+// Sets all bits to true
+MappedBitArray& MappedBitArray::set() {
+    check_writable();
+    if (m_bit_count == 0) {
+        return *this;
+    }
+
+    std::fill(m_blocks, m_blocks + used_blocks(), ~0UL);
+    m_blocks[used_blocks() - 1] = last_block();
+    return *this;
+}
+
+// Sets bit at index n to false
+MappedBitArray& MappedBitArray::reset(size_t n) {
+    return set(n, false);
+}
+
+// Sets all bits to false
+MappedBitArray& MappedBitArray::reset() {
+    check_writable();
+    std::fill(m_blocks, m_blocks + used_blocks(), 0UL);
+    return *this;
+}
+
+// Returns value of bit at index n
+bool MappedBitArray::operator[](size_t n) const {
+    check_index(n);
+    return (m_blocks[n / BITS_PER_BLOCK] >> (n % BITS_PER_BLOCK)) & 1;
+}
+
+// Returns true if array contains at least one true bit
+bool MappedBitArray::any() const {
+    if (m_bit_count == 0) {
+        return false;
+    }
+    const unsigned long* first = m_blocks;
+    const unsigned long* last = first + used_blocks() - 1;
+    return std::any_of(first, last, [](unsigned long b) { return b != 0; }) || last_block() != 0;
+}
+
+// Returns true if all bits are false
+bool MappedBitArray::none() const {
+    return !any();
+}
+
+// Counts number of true bits
+size_t MappedBitArray::count() const {
+    if (m_bit_count == 0) {
+        return 0;
+    }
+    return bitops::popcount(m_blocks, used_blocks() - 1)
+         + static_cast<size_t>(__builtin_popcountl(last_block()));
+}
+
+// Copies the contents into an ordinary BitArray
+BitArray MappedBitArray::to_bit_array() const {
+    if (m_bit_count > static_cast<size_t>(INT_MAX)) {
+        throw std::length_error("MappedBitArray is too large for BitArray");
+    }
+
+    // Whole blocks go straight into the result; the file may hold stray
+    // bits past the size, so the last block is masked
+    BitArray result(static_cast<int>(m_bit_count));
+    if (m_bit_count > 0) {
+        unsigned long* data = result.data();
+        std::copy(m_blocks, m_blocks + used_blocks() - 1, data);
+        data[used_blocks() - 1] = last_block();
+    }
+    return result;
+}
+
+// Writes modified pages back to the file
+void MappedBitArray::flush() {
+    if (m_mapping != nullptr && m_mode == Mode::ReadWrite) {
+        if (::msync(m_mapping, m_mapping_size, MS_SYNC) != 0) {
+            throw std::runtime_error(std::string("Cannot flush mapped bit array (") + std::strerror(errno) + ")");
+        }
+    }
+}
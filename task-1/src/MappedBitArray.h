@@ -0,0 +1,104 @@
+#ifndef MAPPEDBITARRAY_H
+#define MAPPEDBITARRAY_H
+
+#include <cstddef>
+#include <string>
+
+class BitArray;
+
+// Bit array living in a memory-mapped file (layout in BitArrayFormat.h).
+//
+// Opening maps the file instead of reading it, so even huge arrays are
+// available immediately and pages are loaded on first touch. In read-write
+// mode set() and reset() write straight into the page cache; flush() forces
+// the changes to disk, otherwise the kernel writes them back on its own.
+class MappedBitArray {
+public:
+    enum class Mode { ReadOnly, ReadWrite };
+
+private:
+    int m_fd;
+    unsigned char* m_mapping; // Whole file, header included
+    size_t m_mapping_size;
+    unsigned long* m_blocks;  // Points past the header
+    size_t m_bit_count;
+    Mode m_mode;
+
+    static const size_t BITS_PER_BLOCK = sizeof(unsigned long) * 8;
+
+    size_t used_blocks() const { return (m_bit_count + BITS_PER_BLOCK - 1) / BITS_PER_BLOCK; }
+
+    // Last block with bits past the size masked off (the file may come from elsewhere)
+    unsigned long last_block() const;
+
+    void check_index(size_t n) const;
+    void check_writable() const;
+
+    // Maps fd, which holds a file of file_size bytes
+    void map(const std::string& path, size_t file_size);
+    void unmap();
+
+    MappedBitArray();
+
+public:
+    // Maps an existing file. Throws std::runtime_error if it cannot be
+    // opened or is not a valid uncompressed bit array file.
+    explicit MappedBitArray(const std::string& path, Mode mode = Mode::ReadOnly);
+
+    // Creates (or truncates) a file of num_bits false bits, mapped read-write
+    static MappedBitArray create(const std::string& path, size_t num_bits);
+
+    // Creates a file with a copy of bits, mapped read-write
+    static MappedBitArray create(const std::string& path, const BitArray& bits);
+
+    ~MappedBitArray();
+
+    MappedBitArray(MappedBitArray&& other) noexcept;
+    MappedBitArray& operator=(MappedBitArray&& other) noexcept;
+    MappedBitArray(const MappedBitArray&) = delete;
+    MappedBitArray& operator=(const MappedBitArray&) = delete;
+
+    // Sets bit at index n to value val (read-write mappings only)
+    MappedBitArray& set(size_t n, bool val = true);
+
+    // Sets all bits to true
+    MappedBitArray& set();
+
+    // Sets bit at index n to false
+    MappedBitArray& reset(size_t n);
+
+    // Sets all bits to false
+    MappedBitArray& reset();
+
+    // Returns value of bit at index n
+    bool operator[](size_t n) const;
+
+    // Returns true if array contains at least one true bit
+    bool any() const;
+
+    // Returns true if all bits are false
+    bool none() const;
+
+    // Counts number of true bits
+    size_t count() const;
+
+    // Returns size of array in bits
+    size_t size() const { return m_bit_count; }
+
+    // Returns true if array is empty
+    bool empty() const { return m_bit_count == 0; }
+
+    // Returns true if the mapping accepts writes
+    bool writable() const { return m_mode == Mode::ReadWrite; }
+
+    // Raw blocks of the mapping
+    const unsigned long* data() const { return m_blocks; }
+
+    // Copies the contents into an ordinary BitArray
+    BitArray to_bit_array() const;
+
+    // Writes modified pages back to the file and waits for completion
+    void flush();
+};
+
+#endif // MAPPEDBITARRAY_H
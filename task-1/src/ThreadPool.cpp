@@ -0,0 +1,118 @@
+#include "ThreadPool.h"
+
+namespace {
+
+// Pool whose job the current thread is running, if any
+thread_local const ThreadPool* t_running_pool = nullptr;
+
+// Marks the calling thread as running a job of pool until destroyed
+class RunningPool {
+private:
+    const ThreadPool* m_previous;
+
+public:
+    explicit RunningPool(const ThreadPool* pool) : m_previous(t_running_pool) { t_running_pool = pool; }
+    ~RunningPool() { t_running_pool = m_previous; }
+
+    RunningPool(const RunningPool&) = delete;
+    RunningPool& operator=(const RunningPool&) = delete;
+};
+
+} // namespace
+
+ThreadPool::ThreadPool(unsigned threads)
+    : m_body(nullptr), m_count(0), m_grain(1), m_next_chunk(0),
+      m_busy_workers(0), m_job_id(0), m_stop(false) {
+    for (unsigned i = 1; i < threads; ++i) {
+        m_workers.emplace_back(&ThreadPool::worker_loop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+}
+
+// Waits for a new job, takes chunks until none are left, reports back
+void ThreadPool::worker_loop() {
+    RunningPool running(this);
+    uint64_t seen_job = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&] { return m_stop || m_job_id != seen_job; });
+            if (m_stop) {
+                return;
+            }
+            seen_job = m_job_id;
+        }
+
+        run_chunks();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_busy_workers == 0) {
+            m_done.notify_one();
+        }
+    }
+}
+
+// Takes chunks of the current job off the shared counter
+void ThreadPool::run_chunks() {
+    size_t chunks = (m_count + m_grain - 1) / m_grain;
+    for (size_t chunk = m_next_chunk++; chunk < chunks; chunk = m_next_chunk++) {
+        size_t begin = chunk * m_grain;
+        size_t end = begin + m_grain < m_count ? begin + m_grain : m_count;
+        (*m_body)(begin, end);
+    }
+}
+
+void ThreadPool::parallel_for(size_t count, size_t grain,
+                              const std::function<void(size_t, size_t)>& body) {
+    if (count == 0) {
+        return;
+    }
+    if (grain == 0) {
+        grain = 1;
+    }
+
+    // Not worth waking anybody up. A call from inside a body of this pool
+    // runs inline too: the pool is busy with the outer job, and waiting for
+    // it here would deadlock.
+    if (m_workers.empty() || count <= grain || t_running_pool == this) {
+        body(0, count);
+        return;
+    }
+
+    std::lock_guard<std::mutex> call_lock(m_call_mutex);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_body = &body;
+        m_count = count;
+        m_grain = grain;
+        m_next_chunk = 0;
+        m_busy_workers = m_workers.size();
+        ++m_job_id;
+    }
+    m_wake.notify_all();
+
+    {
+        RunningPool running(this);
+        run_chunks();
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [&] { return m_busy_workers == 0; });
+    m_body = nullptr;
+}
+
+// Pool shared by all callers that do not bring their own
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
@@ -0,0 +1,66 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for splitting loops over block ranges.
+// Only one parallel_for runs at a time; concurrent callers wait their turn.
+// A parallel_for nested in a body of the same pool runs on the calling thread.
+class ThreadPool {
+private:
+    std::vector<std::thread> m_workers;
+    std::mutex m_call_mutex; // Serializes parallel_for callers
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+
+    // Current job
+    const std::function<void(size_t, size_t)>* m_body;
+    size_t m_count;
+    size_t m_grain;
+    std::atomic<size_t> m_next_chunk;
+    size_t m_busy_workers;
+    uint64_t m_job_id;
+    bool m_stop;
+
+    void worker_loop();
+    void run_chunks();
+
+public:
+    // threads counts the calling thread too, so threads - 1 workers are started
+    explicit ThreadPool(unsigned threads = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Returns number of threads taking part in a parallel_for
+    unsigned size() const { return static_cast<unsigned>(m_workers.size()) + 1; }
+
+    // Calls body(begin, end) on consecutive ranges of at most grain items
+    // covering [0, count), spread over the pool and the calling thread.
+    // Returns when all ranges are done. body must not throw. Called from
+    // inside a body of this pool, runs the whole loop on the calling thread.
+    void parallel_for(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body);
+
+    // Pool shared by all callers that do not bring their own
+    static ThreadPool& shared();
+};
+
+// Execution policy for bulk BitArray operations: a.and_with(b, par)
+struct ParallelPolicy {
+    ThreadPool* pool = nullptr; // nullptr means ThreadPool::shared()
+
+    ThreadPool& get_pool() const { return pool != nullptr ? *pool : ThreadPool::shared(); }
+};
+
+inline const ParallelPolicy par{};
+
+#endif // THREADPOOL_H
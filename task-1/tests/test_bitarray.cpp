@@ -1,6 +1,67 @@
 #include "../src/BitArray.h"
+#include "../src/BitArena.h"
+#include "../src/BitArrayFormat.h"
+#include "../src/CompressedBitArray.h"
+#include "../src/MappedBitArray.h"
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <new>
+#include <utility>
+
+// Счётчик выделений памяти, чтобы проверять работу без кучи
+static size_t g_allocations = 0;
+
+void* operator new(size_t size) {
+    ++g_allocations;
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+// Выровненные версии (их использует ресурс памяти по умолчанию)
+void* operator new(size_t size, std::align_val_t align) {
+    ++g_allocations;
+    size_t alignment = static_cast<size_t>(align);
+    if (void* ptr = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept {
+    std::free(ptr);
+}
 
 void test_constructor() {
     std::cout << "Testing constructors..." << std::endl;
@@ -153,6 +214,38 @@ void test_shift_operations() {
     std::cout << "✓ Shift operations test passed" << std::endl;
 }
 
+void test_shift_multiblock() {
+    std::cout << "Testing multi-block shifts..." << std::endl;
+    
+    // 200 бит - несколько блоков и неполный последний блок
+    const int size = 200;
+    BitArray arr(size);
+    for (int i = 0; i < size; ++i) {
+        arr[i] = (i % 3 == 0) || (i % 7 == 0);
+    }
+    std::string bits = arr.to_string();
+    
+    int shifts[] = {1, 5, 63, 64, 65, 128, 130, 199};
+    for (int n : shifts) {
+        // Эталон: сдвиг строки с заполнением нулями
+        std::string expected_left = bits.substr(n) + std::string(n, '0');
+        std::string expected_right = std::string(n, '0') + bits.substr(0, size - n);
+        
+        assert((arr << n).to_string() == expected_left);
+        assert((arr >> n).to_string() == expected_right);
+        assert((arr >> n).count() == static_cast<size_t>(std::count(expected_right.begin(), expected_right.end(), '1')));
+    }
+    
+    // Биты, ушедшие за конец, не должны возвращаться
+    BitArray tail(70);
+    tail.set();
+    tail >>= 10;
+    tail <<= 10;
+    assert(tail.count() == 60);
+    
+    std::cout << "✓ Multi-block shifts test passed" << std::endl;
+}
+
 void test_count_any_none() {
     std::cout << "Testing count/any/none..." << std::endl;
     
@@ -171,6 +264,17 @@ void test_count_any_none() {
     assert(mixed.any());
     assert(!mixed.none());
     
+    // Большой массив: проходит через векторные ядра и хвост
+    BitArray big(100003);
+    size_t expected = 0;
+    for (int i = 0; i < big.size(); i += 3) {
+        big.set(i);
+        ++expected;
+    }
+    assert(big.count() == expected);
+    big.set();
+    assert(big.count() == 100003);
+    
     std::cout << "✓ Count/any/none test passed" << std::endl;
 }
 
@@ -297,6 +401,537 @@ void test_comparison_operators() {
     std::cout << "✓ Comparison operators test passed" << std::endl;
 }
 
+void test_move_semantics() {
+    std::cout << "Testing move semantics..." << std::endl;
+    
+    // Маленькие массивы хранятся внутри объекта
+    size_t before = g_allocations;
+    BitArray a(128, 0b1011);
+    BitArray b(128);
+    b.set(100);
+    BitArray c = (a | b) << 1;
+    BitArray d = ~c;
+    d &= a;
+    BitArray moved(std::move(c));
+    assert(g_allocations == before);
+    
+    assert(moved.count() == 3);
+    assert(moved[0] == true && moved[99] == true);
+    assert(c.empty());
+    
+    // Большой массив: перемещение забирает буфер без копирования
+    BitArray big(1000);
+    big.set(999);
+    before = g_allocations;
+    BitArray big_moved(std::move(big));
+    assert(g_allocations == before);
+    assert(big.empty());
+    assert(big_moved[999] == true);
+    
+    // Перемещающее присваивание между встроенным и кучным хранилищем
+    a = std::move(big_moved);
+    assert(a.size() == 1000 && a[999] == true);
+    big_moved = std::move(moved);
+    assert(big_moved.size() == 128 && big_moved.count() == 3);
+    
+    // Перемещённый объект можно переиспользовать
+    big.push_back(true);
+    assert(big.size() == 1 && big[0] == true);
+    
+    // Обмен встроенного и кучного массивов
+    BitArray small(10, 0b1);
+    BitArray large(500);
+    large.set(499);
+    small.swap(large);
+    assert(small.size() == 500 && small[499] == true);
+    assert(large.size() == 10 && large[0] == true);
+    
+    // push_back через границу встроенного буфера
+    BitArray grow;
+    for (int i = 0; i < 600; ++i) {
+        grow.push_back(i % 5 == 0);
+    }
+    assert(grow.size() == 600 && grow.count() == 120);
+    
+    // resize с заполнением единицами дополняет неполный последний блок
+    BitArray filled(3, 0b101);
+    filled.resize(300, true);
+    assert(filled.count() == 299);
+    filled.resize(2);
+    assert(filled.to_string() == "10");
+    
+    std::cout << "✓ Move semantics test passed" << std::endl;
+}
+
+void test_expressions() {
+    std::cout << "Testing bitwise expressions..." << std::endl;
+    
+    const int size = 1000;
+    BitArray a(size), b(size), c(size);
+    for (int i = 0; i < size; ++i) {
+        a[i] = (i % 2 == 0);
+        b[i] = (i % 3 == 0);
+        c[i] = (i % 5 == 0);
+    }
+    
+    // Всё выражение считается за один проход с одним выделением памяти
+    size_t before = g_allocations;
+    BitArray r = (a & b) | ~c;
+    assert(g_allocations == before + 1);
+    
+    for (int i = 0; i < size; ++i) {
+        bool expected = ((i % 2 == 0) && (i % 3 == 0)) || (i % 5 != 0);
+        assert(r[i] == expected);
+    }
+    
+    // Инверсия не оставляет единиц за концом массива
+    BitArray tail(70);
+    BitArray inverted = ~tail;
+    assert(inverted.count() == 70);
+    assert((~tail).count() == 70);
+    
+    // Подсчёт без материализации
+    before = g_allocations;
+    assert((a & b).count() == 167);
+    assert((a ^ a).none());
+    assert(g_allocations == before);
+    
+    // Выражение с участием самого массива
+    BitArray x = a;
+    x = x ^ b;
+    assert(x == BitArray(a ^ b));
+    x &= b | c;
+    assert(x == BitArray((a ^ b) & (b | c)));
+    
+    // Сдвиг выражения
+    BitArray shifted = (a | b) << 1;
+    assert(shifted[0] == false && shifted[1] == true);
+    
+    // Разные размеры - исключение, как и раньше
+    BitArray other(size + 1);
+    bool thrown = false;
+    try {
+        BitArray bad = (a & b) | other;
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+    
+    std::cout << "✓ Bitwise expressions test passed" << std::endl;
+}
+
+void test_arena() {
+    std::cout << "Testing arena storage..." << std::endl;
+    
+    BitArena arena(1 << 20);
+    
+    // Много массивов из одной арены - только выделение первого чанка
+    size_t before = g_allocations;
+    for (int round = 0; round < 100; ++round) {
+        BitArray a(1000, 0, &arena);
+        BitArray b(1000, 0, &arena);
+        a.set(round);
+        b.set(round + 1);
+        BitArray c(a | b, &arena);
+        c >>= 3;
+        assert(c.count() == 2);
+        assert(c.resource() == &arena);
+        
+        // Буферы выровнены по кэш-линии
+        assert(reinterpret_cast<std::uintptr_t>(c.data()) % 64 == 0);
+        
+        c.push_back(true);
+        c.resize(5000, true);
+        assert(c.count() == 2 + 1 + 3999);
+    }
+    assert(g_allocations - before <= 1);
+    assert(arena.allocated() > 0);
+    
+    // Перемещение забирает ресурс вместе с буфером
+    BitArray owned(1000, 0, &arena);
+    BitArray moved(std::move(owned));
+    assert(moved.resource() == &arena);
+    
+    // Копия по умолчанию уходит в ресурс по умолчанию
+    BitArray copy(moved);
+    assert(copy.resource() == std::pmr::get_default_resource());
+    moved.clear();
+    
+    arena.release();
+    assert(arena.allocated() == 0);
+    
+    // Неудачное выделение не засчитывается
+    BitArena empty_arena(1024, std::pmr::null_memory_resource());
+    bool thrown = false;
+    try {
+        BitArray failed(100000, 0, &empty_arena);
+    } catch (const std::bad_alloc&) {
+        thrown = true;
+    }
+    assert(thrown);
+    assert(empty_arena.allocated() == 0);
+    
+    std::cout << "✓ Arena storage test passed" << std::endl;
+}
+
+void test_find_and_iterate() {
+    std::cout << "Testing set bit search..." << std::endl;
+    
+    BitArray empty;
+    assert(empty.find_first() == BitArray::npos);
+    assert(empty.find_last() == BitArray::npos);
+    assert(empty.ones().begin() == empty.ones().end());
+    
+    BitArray zeros(300);
+    assert(zeros.find_first() == BitArray::npos);
+    assert(zeros.find_next(5) == BitArray::npos);
+    
+    // Разреженный массив: единицы в разных блоках
+    BitArray sparse(100000);
+    size_t positions[] = {0, 63, 64, 130, 4095, 70000, 99999};
+    for (size_t pos : positions) {
+        sparse.set(static_cast<int>(pos));
+    }
+    
+    assert(sparse.find_first() == 0);
+    assert(sparse.find_last() == 99999);
+    assert(sparse.find_next(0) == 63);
+    assert(sparse.find_next(63) == 64);
+    assert(sparse.find_next(65) == 130);
+    assert(sparse.find_next(70000) == 99999);
+    assert(sparse.find_next(99999) == BitArray::npos);
+    
+    // Цепочка find_next и range-for дают один и тот же список
+    size_t k = 0;
+    for (size_t pos = sparse.find_first(); pos != BitArray::npos; pos = sparse.find_next(pos)) {
+        assert(pos == positions[k++]);
+    }
+    assert(k == 7);
+    
+    k = 0;
+    for (size_t pos : sparse.ones()) {
+        assert(pos == positions[k++]);
+    }
+    assert(k == 7);
+    
+    BitArray single(10);
+    single.set(9);
+    assert(single.find_first() == 9 && single.find_last() == 9);
+    
+    std::cout << "✓ Set bit search test passed" << std::endl;
+}
+
+// Заполняет массив: разреженный участок, плотный участок и длинная серия единиц
+BitArray make_mixed_bits(int size, int seed) {
+    BitArray bits(size);
+    for (int i = seed; i < 65536; i += 97) {
+        bits.set(i);
+    }
+    for (int i = 65536; i < 131072; ++i) {
+        bits[i] = ((i * 7 + seed) % 5) < 2;
+    }
+    for (int i = 140000 + seed; i < 200000; ++i) {
+        bits.set(i);
+    }
+    return bits;
+}
+
+void test_compressed() {
+    std::cout << "Testing compressed bit array..." << std::endl;
+    
+    // 4 полных чанка и неполный последний
+    const int size = 300000;
+    BitArray dense_a = make_mixed_bits(size, 1);
+    BitArray dense_b = make_mixed_bits(size, 3);
+    
+    CompressedBitArray a(dense_a);
+    CompressedBitArray b(dense_b);
+    assert(a.size() == static_cast<size_t>(size));
+    assert(a.count() == dense_a.count());
+    assert(a.to_bit_array() == dense_a);
+    
+    // Побитовые операции совпадают с BitArray
+    assert((a & b).to_bit_array() == BitArray(dense_a & dense_b));
+    assert((a | b).to_bit_array() == BitArray(dense_a | dense_b));
+    assert((a ^ b).to_bit_array() == BitArray(dense_a ^ dense_b));
+    assert((~a).to_bit_array() == BitArray(~dense_a));
+    assert((~a).count() == size - dense_a.count());
+    assert((a ^ a).none());
+    
+    CompressedBitArray c = a;
+    c &= b;
+    c |= ~b;
+    assert(c.to_bit_array() == BitArray((dense_a & dense_b) | ~dense_b));
+    
+    // Одиночные изменения во всех видах контейнеров
+    for (int i : {5, 98, 65537, 65538, 150000, 299999}) {
+        c.set(i);
+        assert(c[i] == true);
+        c.reset(i);
+        assert(c[i] == false);
+    }
+    
+    // Разреженный массив на 2^32 бит почти не занимает памяти
+    CompressedBitArray huge(size_t(1) << 32);
+    for (size_t i = 0; i < 1000; ++i) {
+        huge.set(i * 4000037);
+    }
+    assert(huge.count() == 1000);
+    assert(huge[4000037] == true && huge[4000038] == false);
+    assert(huge.memory_usage() < 256 * 1024);
+    
+    // Полный массив хранится сериями: 65536 чанков вместо 512 МиБ
+    huge.set();
+    assert(huge.count() == (size_t(1) << 32));
+    assert(huge.memory_usage() < 16 * 1024 * 1024);
+    huge.reset(123);
+    assert(huge.count() == (size_t(1) << 32) - 1);
+    huge.reset();
+    assert(huge.none());
+    
+    // Ошибки как у BitArray
+    bool thrown = false;
+    try {
+        a &= CompressedBitArray(10);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+    
+    thrown = false;
+    try {
+        a.set(size);
+    } catch (const std::out_of_range&) {
+        thrown = true;
+    }
+    assert(thrown);
+    
+    std::cout << "✓ Compressed bit array test passed" << std::endl;
+}
+
+void test_parallel() {
+    std::cout << "Testing parallel bulk operations..." << std::endl;
+    
+    ThreadPool pool(4);
+    ParallelPolicy policy{&pool};
+    
+    // Несколько задач по 8192 блока и неполный хвост
+    const int size = 5000000 + 17;
+    BitArray a(size), b(size);
+    for (int i = 0; i < size; i += 7) {
+        a.set(i);
+    }
+    for (int i = 0; i < size; i += 11) {
+        b.set(i);
+    }
+    
+    BitArray expected_and = a & b;
+    BitArray expected_or = a | b;
+    BitArray expected_xor = a ^ b;
+    
+    BitArray c = a;
+    assert(c.and_with(b, policy) == expected_and);
+    c = a;
+    assert(c.or_with(b, policy) == expected_or);
+    c = a;
+    assert(c.xor_with(b, par) == expected_xor);
+    
+    assert(a.count(policy) == a.count());
+    assert(b.count(par) == b.count());
+    
+    c.reset(policy);
+    assert(c.none() && !c.any(policy));
+    c.set(size - 1);
+    assert(c.any(policy));
+    c.set(policy);
+    assert(c.count(policy) == static_cast<size_t>(size));
+    
+    bool thrown = false;
+    try {
+        c.and_with(BitArray(10), policy);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+    
+    // Вложенный вызов из задачи того же пула выполняется на месте, а не ждёт пул
+    std::atomic<size_t> nested_ok(0);
+    pool.parallel_for(8, 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            if (a.count(policy) == a.count() && b.any(policy)) {
+                ++nested_ok;
+            }
+        }
+    });
+    assert(nested_ok == 8);
+    
+    std::cout << "✓ Parallel bulk operations test passed" << std::endl;
+}
+
+void test_mapped() {
+    std::cout << "Testing memory-mapped bit array..." << std::endl;
+    
+    const std::string path = "test_mapped.bits";
+    
+    // Создание файла и запись прямо в отображение
+    {
+        MappedBitArray mapped = MappedBitArray::create(path, 1000);
+        assert(mapped.size() == 1000 && mapped.none());
+        mapped.set(0);
+        mapped.set(999);
+        mapped.set(500).reset(500);
+        assert(mapped.count() == 2);
+        mapped.flush();
+    }
+    
+    // Повторное открытие видит изменения
+    {
+        MappedBitArray mapped(path);
+        assert(!mapped.writable());
+        assert(mapped.size() == 1000);
+        assert(mapped[0] && mapped[999] && !mapped[500]);
+        assert(mapped.count() == 2);
+        
+        bool thrown = false;
+        try {
+            mapped.set(1);
+        } catch (const std::logic_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+    
+    // Файл из BitArray и обратно
+    BitArray bits(777);
+    for (int i = 0; i < bits.size(); i += 5) {
+        bits.set(i);
+    }
+    {
+        MappedBitArray mapped = MappedBitArray::create(path, bits);
+        assert(mapped.to_bit_array() == bits);
+    }
+    {
+        MappedBitArray mapped(path, MappedBitArray::Mode::ReadWrite);
+        assert(mapped.count() == bits.count());
+        mapped.set();
+        assert(mapped.count() == 777);
+        MappedBitArray moved(std::move(mapped));
+        moved.reset();
+        assert(moved.none());
+    }
+    
+    // Посторонний файл не принимается
+    {
+        std::ofstream junk(path, std::ios::trunc);
+        junk << "#Life 1.06\n0 0\n";
+    }
+    bool thrown = false;
+    try {
+        MappedBitArray mapped(path);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+    
+    std::remove(path.c_str());
+    std::cout << "✓ Memory-mapped bit array test passed" << std::endl;
+}
+
+void test_serialization() {
+    std::cout << "Testing serialization..." << std::endl;
+    
+    // Строковое представление туда и обратно, включая неполный хвост
+    BitArray bits(1003);
+    for (int i = 0; i < bits.size(); ++i) {
+        bits[i] = (i % 3 == 0) || (i > 900);
+    }
+    std::string text = bits.to_string();
+    assert(text.size() == 1003);
+    assert(text.substr(0, 7) == "1001001");
+    assert(BitArray::from_string(text) == bits);
+    assert(BitArray::from_string("") == BitArray());
+    assert(BitArray::from_string("0110").to_string() == "0110");
+    
+    bool thrown = false;
+    try {
+        BitArray::from_string("0101010120");
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+    
+    // Двоичный снимок, без сжатия и со сжатием
+    BitArray sparse(200000);
+    sparse.set(5);
+    for (int i = 100000; i < 150000; ++i) {
+        sparse.set(i);
+    }
+    for (const BitArray* source : {&bits, &sparse}) {
+        std::string raw = source->to_bytes();
+        std::string packed = source->to_bytes(true);
+        assert(BitArray::from_bytes(raw) == *source);
+        assert(BitArray::from_bytes(packed) == *source);
+    }
+    assert(sparse.to_bytes(true).size() < 200);
+    assert(BitArray::from_bytes(BitArray().to_bytes()).empty());
+    
+    // Поля заголовка записаны little-endian независимо от порядка байт машины
+    {
+        std::string raw = sparse.to_bytes(true);
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(raw.data());
+        assert(bytes[8] == 1 && bytes[9] == 0 && bytes[10] == 0 && bytes[11] == 0);
+        assert(bytes[12] == 64 && bytes[13] == 0);
+        // 200000 = 0x030d40
+        assert(bytes[16] == 0x40 && bytes[17] == 0x0d && bytes[18] == 0x03 && bytes[19] == 0);
+        assert(bytes[24] == BITARRAY_RLE && bytes[25] == 0);
+        assert(bytes[32] == (raw.size() - 64) % 256 && bytes[33] == (raw.size() - 64) / 256);
+    }
+    
+    // Несжатый снимок открывается как отображаемый файл
+    const std::string path = "test_snapshot.bits";
+    {
+        std::ofstream out(path, std::ios::binary);
+        std::string raw = sparse.to_bytes();
+        out.write(raw.data(), static_cast<std::streamsize>(raw.size()));
+    }
+    {
+        MappedBitArray mapped(path);
+        assert(mapped.count() == sparse.count());
+    }
+    
+    // Размер данных в заголовке не сходится с числом бит
+    {
+        std::string raw = sparse.to_bytes();
+        BitArrayFileHeader header;
+        std::memcpy(&header, raw.data(), sizeof(header));
+        header.payload_size -= 8;
+        std::memcpy(&raw[0], &header, sizeof(header));
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(raw.data(), static_cast<std::streamsize>(raw.size()));
+    }
+    thrown = false;
+    try {
+        MappedBitArray mapped(path);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+    std::remove(path.c_str());
+    
+    // Повреждённые данные
+    std::string broken = sparse.to_bytes(true);
+    broken.resize(broken.size() - 3);
+    thrown = false;
+    try {
+        BitArray::from_bytes(broken);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+    
+    std::cout << "✓ Serialization test passed" << std::endl;
+}
+
 void test_swap() {
     std::cout << "Testing swap..." << std::endl;
     
@@ -322,12 +957,21 @@ int main() {
     test_bit_operations();
     test_logical_operations();
     test_shift_operations();
+    test_shift_multiblock();
     test_count_any_none();
     test_copy_assignment();
     test_push_back();
     test_index_assignment();
     test_comparison_operators();
     test_swap();
+    test_move_semantics();
+    test_expressions();
+    test_arena();
+    test_find_and_iterate();
+    test_compressed();
+    test_parallel();
+    test_mapped();
+    test_serialization();
     
     std::cout << "==========================" << std::endl;
     std::cout << "All tests passed! ✓" << std::endl;
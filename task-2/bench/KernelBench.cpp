@@ -0,0 +1,58 @@
+#include "../src/Universe.h"
+#include "../src/LifeKernel.h"
+#include <chrono>
+#include <cstdio>
+#include <set>
+
+// Сравнение ядер шага: по слову (прежняя реализация), SSE2 и AVX2.
+// Случайная доска 4096 x 4096, все плитки активны.
+static double measure(lifekernel::Simd simd, const std::set<int>& birth,
+                      const std::set<int>& survival, int generations) {
+    const int size = 4096;
+    Universe universe(size, size);
+    universe.setRules(birth, survival);
+    
+    unsigned seed = 1;
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            seed = seed * 1103515245 + 12345;
+            universe.setCell(x, y, (seed >> 16) % 3 == 0);
+        }
+    }
+    
+    lifekernel::setSimd(simd);
+    auto start = std::chrono::steady_clock::now();
+    universe.nextGenerations(generations);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return static_cast<double>(size) * size * generations / seconds;
+}
+
+int main() {
+    const char* names[] = {"word", "sse2", "avx2"};
+    const lifekernel::Simd kernels[] = {lifekernel::Simd::NONE, lifekernel::Simd::SSE2, lifekernel::Simd::AVX2};
+    const lifekernel::Simd best = lifekernel::bestSimd();
+    
+    struct Rule {
+        const char* name;
+        std::set<int> birth;
+        std::set<int> survival;
+    };
+    const Rule rules[] = {{"B3/S23", {3}, {2, 3}}, {"B36/S23", {3, 6}, {2, 3}}, {"B2/S", {2}, {}},
+                          {"B0148/S048", {0, 1, 4, 8}, {0, 4, 8}}};
+    
+    std::printf("%-12s %-6s %14s %8s\n", "rules", "kernel", "cells/s", "speedup");
+    for (const Rule& rule : rules) {
+        double baseline = 0;
+        for (int k = 0; k < 3; ++k) {
+            if (kernels[k] > best) {
+                continue;
+            }
+            double rate = measure(kernels[k], rule.birth, rule.survival, 100);
+            if (k == 0) {
+                baseline = rate;
+            }
+            std::printf("%-12s %-6s %14.3e %7.2fx\n", rule.name, names[k], rate, rate / baseline);
+        }
+    }
+    return 0;
+}
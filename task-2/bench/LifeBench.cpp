@@ -0,0 +1,129 @@
+#include "../src/Universe.h"
+#include "../src/LifeKernel.h"
+#include "../src/Parser.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Производительность Universe: шаги (nextGenerations), разбор файла
+// (Parser::parse) и запись (saveToFile) в Life 1.06 и RLE на досках от
+// 64^2 до 16384^2 с разной плотностью. Результат - JSON в stdout, чтобы сравнивать прогоны.
+//
+// Аргументы: [максимальная сторона доски] [число потоков]
+
+static const char* BENCH_FILES[] = {"bench_board.life", "bench_board.rle"};
+
+// Минимальное время замера: короткие операции повторяются, пока не наберут его
+static const double MIN_SECONDS = 0.2;
+
+template <class Operation>
+static double secondsPerRun(Operation operation, int& runs) {
+    runs = 0;
+    double total = 0;
+    while (runs == 0 || total < MIN_SECONDS) {
+        auto start = std::chrono::steady_clock::now();
+        operation();
+        total += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        runs++;
+    }
+    return total / runs;
+}
+
+static void fillRandom(Universe& universe, int size, double density) {
+    unsigned long long seed = 88172645463325252ULL;
+    unsigned long long threshold = static_cast<unsigned long long>(density * 4294967296.0);
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            seed ^= seed << 13;
+            seed ^= seed >> 7;
+            seed ^= seed << 17;
+            universe.setCell(x, y, (seed & 0xffffffffULL) < threshold);
+        }
+    }
+}
+
+static const char* simdName(lifekernel::Simd simd) {
+    switch (simd) {
+    case lifekernel::Simd::AVX2: return "avx2";
+    case lifekernel::Simd::SSE2: return "sse2";
+    default: return "none";
+    }
+}
+
+static long long fileSize(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    return static_cast<long long>(file.tellg());
+}
+
+int main(int argc, char* argv[]) {
+    int maxSize = argc > 1 ? std::atoi(argv[1]) : 16384;
+    int threads = argc > 2 ? std::atoi(argv[2]) : 1;
+    const double densities[] = {0.01, 0.1};
+
+    std::vector<std::string> results;
+    char buffer[512];
+
+    for (int size = 64; size <= maxSize; size *= 4) {
+        for (double density : densities) {
+            Universe universe(size, size);
+            universe.setThreads(threads);
+            fillRandom(universe, size, density);
+
+            // Шаги: около 2^30 обновлений клеток на замер
+            double cells = static_cast<double>(size) * size;
+            long long generations = std::max(4LL, std::min(100000LL, static_cast<long long>((1LL << 30) / cells)));
+            universe.nextGeneration();
+            auto start = std::chrono::steady_clock::now();
+            universe.nextGenerations(generations);
+            double stepSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::snprintf(buffer, sizeof(buffer),
+                          "{\"name\": \"step\", \"size\": %d, \"density\": %g, \"generations\": %lld, "
+                          "\"seconds\": %.6f, \"cell_updates_per_second\": %.6e}",
+                          size, density, generations, stepSeconds, cells * generations / stepSeconds);
+            results.push_back(buffer);
+
+            // Запись и разбор того же случайного поля в обоих форматах
+            universe.clear();
+            fillRandom(universe, size, density);
+            for (const char* benchFile : BENCH_FILES) {
+                const char* format = std::strstr(benchFile, ".rle") != nullptr ? "rle" : "life";
+                int runs = 0;
+                double saveSeconds = secondsPerRun([&]() { universe.saveToFile(benchFile); }, runs);
+                long long bytes = fileSize(benchFile);
+                std::snprintf(buffer, sizeof(buffer),
+                              "{\"name\": \"save\", \"format\": \"%s\", \"size\": %d, \"density\": %g, "
+                              "\"bytes\": %lld, \"runs\": %d, \"seconds\": %.6f, \"megabytes_per_second\": %.3f}",
+                              format, size, density, bytes, runs, saveSeconds, bytes / saveSeconds / 1e6);
+                results.push_back(buffer);
+
+                size_t liveCells = 0;
+                Parser parser;
+                parser.setThreads(threads);
+                double parseSeconds = secondsPerRun([&]() {
+                    liveCells = parser.parse(benchFile).coordinates.size();
+                }, runs);
+                std::snprintf(buffer, sizeof(buffer),
+                              "{\"name\": \"parse\", \"format\": \"%s\", \"size\": %d, \"density\": %g, "
+                              "\"bytes\": %lld, \"cells\": %zu, \"runs\": %d, \"seconds\": %.6f, "
+                              "\"megabytes_per_second\": %.3f, \"cells_per_second\": %.6e}",
+                              format, size, density, bytes, liveCells, runs, parseSeconds,
+                              bytes / parseSeconds / 1e6, liveCells / parseSeconds);
+                results.push_back(buffer);
+                std::remove(benchFile);
+            }
+        }
+    }
+
+    std::printf("{\n  \"benchmark\": \"gameoflife\",\n  \"threads\": %d,\n  \"simd\": \"%s\",\n  \"results\": [\n",
+                threads, simdName(lifekernel::getSimd()));
+    for (size_t i = 0; i < results.size(); ++i) {
+        std::printf("    %s%s\n", results[i].c_str(), i + 1 < results.size() ? "," : "");
+    }
+    std::printf("  ]\n}\n");
+    return 0;
+}
@@ -11,7 +11,7 @@ void HelpCommand::execute(GameOfLife& game) {
 
 void TickCommand::execute(GameOfLife& game) {
     if (iterations > 0) {
-        game.getUniverse().nextGenerations(iterations);
+        game.getEngine().nextGenerations(iterations);
     } else {
         std::cout << "Number of iterations must be positive\n";
     }
@@ -19,7 +19,7 @@ void TickCommand::execute(GameOfLife& game) {
 
 void DumpCommand::execute(GameOfLife& game) {
     try {
-        game.getUniverse().saveToFile(filename);
+        game.getEngine().saveToFile(filename);
         std::cout << "Universe saved to " << filename << std::endl;
     } catch (const std::exception& e) {
         std::cout << "Error saving file: " << e.what() << std::endl;
@@ -0,0 +1,135 @@
+#include "FileWriter.h"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+// Число десятичных цифр; длины серий почти всегда меньше 10^4
+size_t digitCount(long long value) {
+    size_t digits = 1;
+    while (value >= 10000) {
+        value /= 10000;
+        digits += 4;
+    }
+    return digits + (value >= 10) + (value >= 100) + (value >= 1000);
+}
+
+}
+
+FileWriter::FileWriter(const std::string& filename)
+    : fd(::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666)),
+      filename(filename), buffer(BUFFER_SIZE), used(0) {
+    if (fd < 0) {
+        throw std::runtime_error("Cannot create file: " + filename);
+    }
+}
+
+FileWriter::~FileWriter() {
+    if (fd >= 0) {
+        try {
+            flush();
+        } catch (const std::exception&) {
+        }
+        ::close(fd);
+    }
+}
+
+void FileWriter::write(const char* data, size_t size) {
+    if (size > buffer.size() - used) {
+        flush();
+    }
+    if (size > buffer.size()) {
+        // Большой кусок пишется напрямую, минуя буфер
+        writeAll(data, size);
+        return;
+    }
+    std::memcpy(buffer.data() + used, data, size);
+    used += size;
+}
+
+void FileWriter::flush() {
+    size_t size = used;
+    used = 0;
+    writeAll(buffer.data(), size);
+}
+
+void FileWriter::writeAll(const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error("Cannot write file: " + filename + ": " + std::strerror(errno));
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+}
+
+void FileWriter::close() {
+    flush();
+    int result = ::close(fd);
+    fd = -1;
+    if (result != 0) {
+        throw std::runtime_error("Cannot write file: " + filename + ": " + std::strerror(errno));
+    }
+}
+
+RleWriter::RleWriter(FileWriter& file, long long originX, long long originY)
+    : file(file), originX(originX), originY(originY),
+      cursorX(0), cursorY(0), runX(0), runLength(0), lineLength(0) {}
+
+void RleWriter::cells(long long x, long long y, long long count) {
+    x -= originX;
+    y -= originY;
+    if (runLength > 0 && y == cursorY && x == runX + runLength) {
+        runLength += count;
+        return;
+    }
+    
+    flushRun();
+    if (y > cursorY) {
+        put(y - cursorY, '$');
+        cursorY = y;
+        cursorX = 0;
+    }
+    if (x > cursorX) {
+        put(x - cursorX, 'b');
+    }
+    runX = x;
+    runLength = count;
+}
+
+void RleWriter::finish() {
+    flushRun();
+    put(1, '!');
+    file.write("\n", 1);
+}
+
+void RleWriter::flushRun() {
+    if (runLength > 0) {
+        put(runLength, 'o');
+        cursorX = runX + runLength;
+        runLength = 0;
+    }
+}
+
+void RleWriter::put(long long count, char tag) {
+    size_t size = count > 1 ? digitCount(count) + 1 : 1;
+    
+    char* pos = file.reserve(FileWriter::MAX_LINE);
+    if (lineLength + size > LINE_LIMIT) {
+        *pos++ = '\n';
+        lineLength = 0;
+    }
+    if (count > 1) {
+        pos = FileWriter::appendNumber(pos, count);
+    }
+    *pos++ = tag;
+    file.commit(pos);
+    lineLength += size;
+}
@@ -0,0 +1,98 @@
+#ifndef FILEWRITER_H
+#define FILEWRITER_H
+
+#include <charconv>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Буферизованная запись файла. Числа форматируются std::to_chars прямо в
+// буфер, а на диск он уходит редкими большими вызовами write(), минуя
+// форматирование и блокировки ostream.
+// Бросает std::runtime_error, если файл не создаётся или запись не удалась.
+class FileWriter {
+public:
+    static constexpr size_t BUFFER_SIZE = 1 << 20;
+    
+    // Запас в буфере под одну строку "x y\n" из двух long long
+    static constexpr size_t MAX_LINE = 48;
+    
+    explicit FileWriter(const std::string& filename);
+    ~FileWriter();
+    
+    FileWriter(const FileWriter&) = delete;
+    FileWriter& operator=(const FileWriter&) = delete;
+    
+    void write(const char* data, size_t size);
+    void write(const std::string& text) { write(text.data(), text.size()); }
+    
+    // Строка Life 1.06 "x y\n"
+    void writeCell(long long x, long long y) {
+        reserve(MAX_LINE);
+        char* pos = appendNumber(buffer.data() + used, x);
+        *pos++ = ' ';
+        pos = appendNumber(pos, y);
+        *pos++ = '\n';
+        used = static_cast<size_t>(pos - buffer.data());
+    }
+    
+    // Освобождает место под size байт и возвращает указатель на него;
+    // записанное учитывается через commit
+    char* reserve(size_t size) {
+        if (used + size > buffer.size()) {
+            flush();
+        }
+        return buffer.data() + used;
+    }
+    
+    void commit(char* end) { used = static_cast<size_t>(end - buffer.data()); }
+    
+    // Пишет число с pos и возвращает конец; нужно до 20 байт
+    static char* appendNumber(char* pos, long long value) {
+        return std::to_chars(pos, pos + 20, value).ptr;
+    }
+    
+    // Сбрасывает буфер и закрывает файл; ошибки записи - исключением.
+    // Деструктор закрывает файл молча, если close не вызывали.
+    void close();
+    
+private:
+    void flush();
+    void writeAll(const char* data, size_t size);
+    
+    int fd;
+    std::string filename;
+    std::vector<char> buffer;
+    size_t used;
+};
+
+// Тело RLE: серии живых клеток подаются по рядам сверху вниз и слева
+// направо, соседние серии склеиваются, строки файла не длиннее LINE_LIMIT.
+// Координаты отсчитываются от левого верхнего угла (originX, originY).
+class RleWriter {
+public:
+    static constexpr size_t LINE_LIMIT = 70;
+    
+    RleWriter(FileWriter& file, long long originX, long long originY);
+    
+    // count живых клеток с (x, y) вправо
+    void cells(long long x, long long y, long long count);
+    
+    // Последняя серия и '!'
+    void finish();
+    
+private:
+    void flushRun();
+    void put(long long count, char tag);
+    
+    FileWriter& file;
+    long long originX;
+    long long originY;
+    long long cursorX; // первая ещё не записанная клетка ряда cursorY
+    long long cursorY;
+    long long runX;
+    long long runLength;
+    size_t lineLength;
+};
+
+#endif
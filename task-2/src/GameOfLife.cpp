@@ -1,27 +1,50 @@
 #include "GameOfLife.h"
 #include "Command.h"
+#include <algorithm>
 #include <iostream>
 #include <memory>
+#include <stdexcept>
 
-GameOfLife::GameOfLife() : universe(40, 20, "Default Universe"), running(true) {
-    universe.setCell(1, 0, true);
-    universe.setCell(2, 1, true);
-    universe.setCell(0, 2, true);
-    universe.setCell(1, 2, true);
-    universe.setCell(2, 2, true);
+GameOfLife::GameOfLife() : engine(std::make_unique<Universe>(40, 20, "Default Universe")), running(true) {
+    engine->setCell(1, 0, true);
+    engine->setCell(2, 1, true);
+    engine->setCell(0, 2, true);
+    engine->setCell(1, 2, true);
+    engine->setCell(2, 2, true);
 }
 
-GameOfLife::GameOfLife(const std::string& filename) : universe(filename), running(true) {}
+GameOfLife::GameOfLife(const std::string& filename, const std::string& engineName, int threads)
+    : engine(LifeEngine::create(engineName, filename, threads)), running(true) {}
+
+Universe& GameOfLife::getUniverse() {
+    Universe* universe = dynamic_cast<Universe*>(engine.get());
+    if (universe == nullptr) {
+        throw std::logic_error("Game does not use the universe engine");
+    }
+    return *universe;
+}
+
+const Universe& GameOfLife::getUniverse() const {
+    const Universe* universe = dynamic_cast<const Universe*>(engine.get());
+    if (universe == nullptr) {
+        throw std::logic_error("Game does not use the universe engine");
+    }
+    return *universe;
+}
 
 void GameOfLife::printUniverse() const {
-    std::cout << "\nUniverse: " << universe.getName() << std::endl;
-    std::cout << "Rules: " << universe.getRulesString() << std::endl;
-    std::cout << "Generation: " << universe.getGeneration() << std::endl;
+    std::cout << "\nUniverse: " << engine->getName() << std::endl;
+    std::cout << "Rules: " << engine->getRulesString() << std::endl;
+    std::cout << "Generation: " << engine->getGeneration() << std::endl;
     std::cout << std::endl;
     
-    for (int y = 0; y < universe.getHeight(); ++y) {
-        for (int x = 0; x < universe.getWidth(); ++x) {
-            std::cout << (universe.getCell(x, y) ? "■ " : "· ");
+    int viewX = engine->getViewX();
+    int viewY = engine->getViewY();
+    int width = std::min(engine->getWidth(), MAX_PRINT_SIZE);
+    int height = std::min(engine->getHeight(), MAX_PRINT_SIZE);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            std::cout << (engine->getCell(viewX + x, viewY + y) ? "■ " : "· ");
         }
         std::cout << std::endl;
     }
@@ -32,7 +55,7 @@ void GameOfLife::showHelp() const {
     std::cout << "Available commands:\n";
     std::cout << "  help - show this help message\n";
     std::cout << "  tick [n] or t [n] - advance n generations (default: 1)\n";
-    std::cout << "  dump <filename> - save universe to file\n";
+    std::cout << "  dump <filename> - save universe to file (*.rle - RLE, otherwise Life 1.06)\n";
     std::cout << "  exit - quit the game\n";
 }
 
@@ -63,11 +86,12 @@ void GameOfLife::run() {
     }
 }
 
-void GameOfLife::runOffline(const std::string& inputFile, const std::string& outputFile, int iterations) {
+void GameOfLife::runOffline(const std::string& inputFile, const std::string& outputFile, int iterations,
+                            int threads, const std::string& engineName) {
     try {
-        Universe offlineUniverse(inputFile);
-        offlineUniverse.nextGenerations(iterations);
-        offlineUniverse.saveToFile(outputFile);
+        std::unique_ptr<LifeEngine> offlineEngine = LifeEngine::create(engineName, inputFile, threads);
+        offlineEngine->nextGenerations(iterations);
+        offlineEngine->saveToFile(outputFile);
         std::cout << "Completed " << iterations << " iterations and saved to " << outputFile << std::endl;
     } catch (const std::exception& e) {
         std::cout << "Error: " << e.what() << std::endl;
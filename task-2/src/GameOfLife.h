@@ -1,20 +1,26 @@
 #ifndef GAMEOFLIFE_H
 #define GAMEOFLIFE_H
 
+#include "LifeEngine.h"
 #include "Universe.h"
+#include <memory>
 #include <string>
 
 class GameOfLife {
 private:
-    Universe universe;
+    std::unique_ptr<LifeEngine> engine;
     bool running;
     
+    // Наибольшая сторона печатаемой области, остальное поле не выводится
+    static constexpr int MAX_PRINT_SIZE = 256;
+    
 public:
     GameOfLife();
-    GameOfLife(const std::string& filename);
+    GameOfLife(const std::string& filename, const std::string& engineName = "universe", int threads = 1);
     
     void run();
-    void runOffline(const std::string& inputFile, const std::string& outputFile, int iterations);
+    void runOffline(const std::string& inputFile, const std::string& outputFile, int iterations,
+                    int threads = 1, const std::string& engineName = "universe");
     
     // Публичные методы для доступа командам
     void printUniverse() const;
@@ -23,8 +29,12 @@ public:
     bool isRunning() const { return running; }
     void setRunning(bool value) { running = value; }
     
-    Universe& getUniverse() { return universe; }
-    const Universe& getUniverse() const { return universe; }
+    LifeEngine& getEngine() { return *engine; }
+    const LifeEngine& getEngine() const { return *engine; }
+    
+    // Бросают std::logic_error, если выбран другой движок
+    Universe& getUniverse();
+    const Universe& getUniverse() const;
 };
 
 #endif
\ No newline at end of file
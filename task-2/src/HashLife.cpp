@@ -0,0 +1,443 @@
+#include "HashLife.h"
+#include "LifeKernel.h"
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+size_t HashLife::NodeKeyHash::operator()(const NodeKey& key) const {
+    size_t hash = 0;
+    for (const Node* child : {key.nw, key.ne, key.sw, key.se}) {
+        size_t value = reinterpret_cast<uintptr_t>(child);
+        hash ^= value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    }
+    return hash;
+}
+
+HashLife::HashLife(int w, int h, const std::string& universeName)
+    : deadLeaf{nullptr, nullptr, nullptr, nullptr, 0, 0, nullptr},
+      aliveLeaf{nullptr, nullptr, nullptr, nullptr, 0, 1, nullptr},
+      viewX(0), viewY(0), width(w), height(h), name(universeName), generation(0) {
+    reset();
+    setRules({3}, {2, 3});
+}
+
+HashLife::HashLife(const std::string& filename, int threads) : HashLife(0, 0) {
+    loadFromFile(filename, threads);
+}
+
+void HashLife::reset() {
+    table.clear();
+    nodes.clear();
+    emptyNodes.clear();
+    partialResults.clear();
+    partialStep = -1;
+    gcThreshold = MAX_NODES;
+
+    root = empty(3);
+    originX = 0;
+    originY = 0;
+}
+
+// Клетки остаются на своих координатах. Они копятся в списке, и дерево
+// строится снизу вверх одним проходом: setCell на каждую клетку оставлял бы
+// в таблице весь заменённый путь от корня.
+void HashLife::loadFromFile(const std::string& filename, int threads) {
+    std::vector<Cell> cells;
+    loadPattern(filename, threads, true, [this](const GameConfig& config, int x, int y, int w, int h) {
+        setRules(config.birthRules, config.survivalRules);
+        name = config.name;
+        viewX = x;
+        viewY = y;
+        width = w;
+        height = h;
+    }, [&cells](int x, int y) {
+        cells.emplace_back(x, y);
+    });
+    if (cells.empty()) {
+        return;
+    }
+
+    long long minX = cells[0].first;
+    long long minY = cells[0].second;
+    long long maxX = minX;
+    long long maxY = minY;
+    for (const Cell& cell : cells) {
+        minX = std::min(minX, cell.first);
+        minY = std::min(minY, cell.second);
+        maxX = std::max(maxX, cell.first);
+        maxY = std::max(maxY, cell.second);
+    }
+
+    int level = 3;
+    while ((1LL << level) <= std::max(maxX - minX, maxY - minY)) {
+        ++level;
+    }
+    for (Cell& cell : cells) {
+        cell.first -= minX;
+        cell.second -= minY;
+    }
+
+    reset();
+    root = build(level, cells.data(), cells.data() + cells.size());
+    originX = minX;
+    originY = minY;
+}
+
+HashLife::Node* HashLife::build(int level, Cell* begin, Cell* end) {
+    if (begin == end) {
+        return empty(level);
+    }
+    if (level == 0) {
+        return leaf(true);
+    }
+
+    long long half = 1LL << (level - 1);
+    Cell* south = std::partition(begin, end, [half](const Cell& cell) { return cell.second < half; });
+    Cell* northEast = std::partition(begin, south, [half](const Cell& cell) { return cell.first < half; });
+    Cell* southEast = std::partition(south, end, [half](const Cell& cell) { return cell.first < half; });
+    for (Cell* cell = northEast; cell != south; ++cell) {
+        cell->first -= half;
+    }
+    for (Cell* cell = south; cell != end; ++cell) {
+        cell->second -= half;
+        if (cell >= southEast) {
+            cell->first -= half;
+        }
+    }
+
+    return join(build(level - 1, begin, northEast), build(level - 1, northEast, south),
+                build(level - 1, south, southEast), build(level - 1, southEast, end));
+}
+
+HashLife::Node* HashLife::join(Node* nw, Node* ne, Node* sw, Node* se) {
+    NodeKey key{nw, ne, sw, se};
+    auto found = table.find(key);
+    if (found != table.end()) {
+        return found->second;
+    }
+
+    long long population = nw->population + ne->population + sw->population + se->population;
+    nodes.push_back(Node{nw, ne, sw, se, nw->level + 1, population, nullptr});
+    Node* node = &nodes.back();
+    table.emplace(key, node);
+    return node;
+}
+
+HashLife::Node* HashLife::empty(int level) {
+    if (emptyNodes.empty()) {
+        emptyNodes.push_back(&deadLeaf);
+    }
+    while (static_cast<int>(emptyNodes.size()) <= level) {
+        Node* e = emptyNodes.back();
+        emptyNodes.push_back(join(e, e, e, e));
+    }
+    return emptyNodes[level];
+}
+
+HashLife::Node* HashLife::center(Node* node) {
+    return join(node->nw->se, node->ne->sw, node->sw->ne, node->se->nw);
+}
+
+// Узел 4x4: центральные 2x2 клетки через одно поколение
+HashLife::Node* HashLife::baseStep(Node* node) {
+    bool cells[4][4];
+    Node* quads[2][2] = {{node->nw, node->ne}, {node->sw, node->se}};
+    for (int y = 0; y < 4; ++y) {
+        for (int x = 0; x < 4; ++x) {
+            Node* quad = quads[y / 2][x / 2];
+            Node* cell = (y % 2 == 0) ? (x % 2 == 0 ? quad->nw : quad->ne)
+                                      : (x % 2 == 0 ? quad->sw : quad->se);
+            cells[y][x] = cell == &aliveLeaf;
+        }
+    }
+
+    Node* next[2][2];
+    for (int y = 1; y <= 2; ++y) {
+        for (int x = 1; x <= 2; ++x) {
+            int neighbors = 0;
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    if ((dx != 0 || dy != 0) && cells[y + dy][x + dx]) {
+                        neighbors++;
+                    }
+                }
+            }
+            unsigned mask = cells[y][x] ? survivalMask : birthMask;
+            next[y - 1][x - 1] = leaf((mask >> neighbors) & 1);
+        }
+    }
+    return join(next[0][0], next[0][1], next[1][0], next[1][1]);
+}
+
+HashLife::Node* HashLife::step(Node* node, int stepLevel) {
+    int level = node->level;
+    if (node->population == 0) {
+        return empty(level - 1);
+    }
+
+    bool full = stepLevel == level - 2;
+    if (full && node->result != nullptr) {
+        return node->result;
+    }
+    if (!full) {
+        auto found = partialResults.find(node);
+        if (found != partialResults.end()) {
+            return found->second;
+        }
+    }
+
+    Node* result;
+    if (level == 2) {
+        result = baseStep(node);
+    } else {
+        // Девять перекрывающихся квадратов уровня level - 1
+        Node* n00 = node->nw;
+        Node* n01 = join(node->nw->ne, node->ne->nw, node->nw->se, node->ne->sw);
+        Node* n02 = node->ne;
+        Node* n10 = join(node->nw->sw, node->nw->se, node->sw->nw, node->sw->ne);
+        Node* n11 = center(node);
+        Node* n12 = join(node->ne->sw, node->ne->se, node->se->nw, node->se->ne);
+        Node* n20 = node->sw;
+        Node* n21 = join(node->sw->ne, node->se->nw, node->sw->se, node->se->sw);
+        Node* n22 = node->se;
+
+        // Полный шаг - два полушага по 2^(level-3) поколений.
+        // Короткий шаг - сначала просто центры, затем весь шаг на следующем уровне.
+        Node* r00, * r01, * r02, * r10, * r11, * r12, * r20, * r21, * r22;
+        int innerStep = full ? stepLevel - 1 : stepLevel;
+        if (full) {
+            r00 = step(n00, innerStep);
+            r01 = step(n01, innerStep);
+            r02 = step(n02, innerStep);
+            r10 = step(n10, innerStep);
+            r11 = step(n11, innerStep);
+            r12 = step(n12, innerStep);
+            r20 = step(n20, innerStep);
+            r21 = step(n21, innerStep);
+            r22 = step(n22, innerStep);
+        } else {
+            r00 = center(n00);
+            r01 = center(n01);
+            r02 = center(n02);
+            r10 = center(n10);
+            r11 = center(n11);
+            r12 = center(n12);
+            r20 = center(n20);
+            r21 = center(n21);
+            r22 = center(n22);
+        }
+
+        result = join(step(join(r00, r01, r10, r11), innerStep),
+                      step(join(r01, r02, r11, r12), innerStep),
+                      step(join(r10, r11, r20, r21), innerStep),
+                      step(join(r11, r12, r21, r22), innerStep));
+    }
+
+    if (full) {
+        node->result = result;
+    } else {
+        partialResults.emplace(node, result);
+    }
+    return result;
+}
+
+// Обрамляет корень пустыми узлами, не сдвигая клетки
+void HashLife::expand() {
+    if (root->level >= MAX_LEVEL) {
+        throw std::overflow_error("Pattern is too large for HashLife");
+    }
+
+    Node* old = root;
+    Node* e = empty(old->level - 1);
+    root = join(join(e, e, e, old->nw),
+                join(e, e, old->ne, e),
+                join(e, old->sw, e, e),
+                join(old->se, e, e, e));
+
+    long long half = 1LL << (old->level - 1);
+    originX -= half;
+    originY -= half;
+}
+
+// Шаг на 2^stepLevel поколений. Корень расширяется, пока узор не окажется
+// в его центральной четверти: тогда за шаг он не выйдет за пределы
+// результата (центральной половины).
+void HashLife::advance(int stepLevel) {
+    if (partialStep != stepLevel) {
+        partialResults.clear();
+        partialStep = stepLevel;
+    }
+
+    while (root->level < stepLevel + 3 || center(center(root))->population != root->population) {
+        expand();
+    }
+
+    long long quarter = 1LL << (root->level - 2);
+    root = step(root, stepLevel);
+    originX += quarter;
+    originY += quarter;
+    generation += 1LL << stepLevel;
+
+    if (nodes.size() > gcThreshold) {
+        collectGarbage();
+    }
+}
+
+HashLife::Node* HashLife::copyNode(Node* node, std::unordered_map<Node*, Node*>& copies) {
+    if (node->level == 0) {
+        return node;
+    }
+    auto found = copies.find(node);
+    if (found != copies.end()) {
+        return found->second;
+    }
+
+    Node* copy = join(copyNode(node->nw, copies), copyNode(node->ne, copies),
+                      copyNode(node->sw, copies), copyNode(node->se, copies));
+    copies.emplace(node, copy);
+    return copy;
+}
+
+// Оставляет только узлы, достижимые из корня (запомненные результаты теряются)
+void HashLife::collectGarbage() {
+    std::deque<Node> oldNodes;
+    oldNodes.swap(nodes);
+    table.clear();
+    emptyNodes.clear();
+    partialResults.clear();
+    partialStep = -1;
+
+    std::unordered_map<Node*, Node*> copies;
+    root = copyNode(root, copies);
+    gcThreshold = nodes.size() * 2 > MAX_NODES ? nodes.size() * 2 : MAX_NODES;
+}
+
+void HashLife::setRules(const std::set<int>& birth, const std::set<int>& survival) {
+    if (birth.count(0) > 0) {
+        throw std::invalid_argument("HashLife does not support rules with B0");
+    }
+
+    birthRules = birth;
+    survivalRules = survival;
+    birthMask = lifekernel::ruleMask(birthRules);
+    survivalMask = lifekernel::ruleMask(survivalRules);
+
+    // Запомненные результаты считались по старым правилам
+    for (Node& node : nodes) {
+        node.result = nullptr;
+    }
+    partialResults.clear();
+}
+
+HashLife::Node* HashLife::setCell(Node* node, long long x, long long y, bool state) {
+    if (node->level == 0) {
+        return leaf(state);
+    }
+
+    long long half = 1LL << (node->level - 1);
+    if (y < half) {
+        if (x < half) {
+            return join(setCell(node->nw, x, y, state), node->ne, node->sw, node->se);
+        }
+        return join(node->nw, setCell(node->ne, x - half, y, state), node->sw, node->se);
+    }
+    if (x < half) {
+        return join(node->nw, node->ne, setCell(node->sw, x, y - half, state), node->se);
+    }
+    return join(node->nw, node->ne, node->sw, setCell(node->se, x - half, y - half, state));
+}
+
+void HashLife::setCell(int x, int y, bool state) {
+    auto outside = [&]() {
+        long long size = 1LL << root->level;
+        return x < originX || x >= originX + size || y < originY || y >= originY + size;
+    };
+
+    if (outside()) {
+        if (!state) {
+            return;
+        }
+        while (outside()) {
+            expand();
+        }
+    }
+    root = setCell(root, x - originX, y - originY, state);
+
+    // Каждый вызов заменяет путь от корня, старые узлы копятся в таблице
+    if (nodes.size() > gcThreshold) {
+        collectGarbage();
+    }
+}
+
+bool HashLife::getCell(int x, int y) const {
+    long long size = 1LL << root->level;
+    long long dx = x - originX;
+    long long dy = y - originY;
+    if (dx < 0 || dx >= size || dy < 0 || dy >= size) {
+        return false;
+    }
+
+    const Node* node = root;
+    while (node->level > 0 && node->population > 0) {
+        long long half = 1LL << (node->level - 1);
+        bool east = dx >= half;
+        bool south = dy >= half;
+        node = south ? (east ? node->se : node->sw) : (east ? node->ne : node->nw);
+        if (east) {
+            dx -= half;
+        }
+        if (south) {
+            dy -= half;
+        }
+    }
+    return node == &aliveLeaf;
+}
+
+void HashLife::nextGeneration() {
+    nextGenerations(1);
+}
+
+void HashLife::nextGenerations(long long n) {
+    for (int stepLevel = 0; n > 0; ++stepLevel, n >>= 1) {
+        if (n & 1) {
+            advance(stepLevel);
+        }
+    }
+}
+
+template <class Callback>
+void HashLife::forEachCell(Node* node, long long x, long long y, Callback callback) const {
+    if (node->population == 0) {
+        return;
+    }
+    if (node->level == 0) {
+        callback(x, y);
+        return;
+    }
+
+    long long half = 1LL << (node->level - 1);
+    forEachCell(node->nw, x, y, callback);
+    forEachCell(node->ne, x + half, y, callback);
+    forEachCell(node->sw, x, y + half, callback);
+    forEachCell(node->se, x + half, y + half, callback);
+}
+
+void HashLife::saveToFile(const std::string& filename) const {
+    std::vector<std::pair<long long, long long>> cells;
+    cells.reserve(static_cast<size_t>(root->population));
+    forEachCell(root, originX, originY, [&](long long x, long long y) {
+        cells.emplace_back(y, x);
+    });
+    saveCells(filename, cells);
+}
+
+std::string HashLife::getRulesString() const {
+    return formatRules(birthRules, survivalRules);
+}
+
+void HashLife::clear() {
+    reset();
+    generation = 0;
+}
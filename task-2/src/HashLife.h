@@ -0,0 +1,155 @@
+#ifndef HASHLIFE_H
+#define HASHLIFE_H
+
+#include "LifeEngine.h"
+#include <cstddef>
+#include <deque>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Движок HashLife (алгоритм Госпера) на бесконечной плоскости.
+//
+// Поле - квадродерево: узел уровня k описывает квадрат 2^k x 2^k через
+// четыре узла уровня k - 1, листья (уровень 0) - отдельные клетки.
+// Одинаковые узлы существуют в одном экземпляре (hash-consing), поэтому
+// повторяющиеся и пустые области хранятся один раз. Для каждого узла
+// запоминается RESULT - его центральный квадрат через 2^(k-2) поколений,
+// так что периодические и разреженные узоры перескакивают 2^k поколений
+// за один вызов.
+//
+// Правила с рождением при 0 соседях (B0) не поддерживаются: пустая плоскость
+// в них не остаётся пустой.
+class HashLife : public LifeEngine {
+private:
+    struct Node {
+        Node* nw;
+        Node* ne;
+        Node* sw;
+        Node* se;
+        int level;
+        long long population;
+        Node* result; // Центр через 2^(level-2) поколений, nullptr - ещё не считан
+    };
+
+    struct NodeKey {
+        Node* nw;
+        Node* ne;
+        Node* sw;
+        Node* se;
+
+        bool operator==(const NodeKey& other) const {
+            return nw == other.nw && ne == other.ne && sw == other.sw && se == other.se;
+        }
+    };
+
+    struct NodeKeyHash {
+        size_t operator()(const NodeKey& key) const;
+    };
+
+    // Наименьший порог сборки мусора (см. gcThreshold)
+    static const size_t MAX_NODES = 1 << 20;
+    // Самый крупный корень: координаты должны помещаться в long long
+    static const int MAX_LEVEL = 60;
+
+    Node deadLeaf;
+    Node aliveLeaf;
+    std::deque<Node> nodes;                          // Все внутренние узлы
+    std::unordered_map<NodeKey, Node*, NodeKeyHash> table;
+    std::vector<Node*> emptyNodes;                   // emptyNodes[k] - пустой узел уровня k
+
+    // Результаты шагов короче 2^(level-2), верны только для partialStep
+    std::unordered_map<Node*, Node*> partialResults;
+    int partialStep;
+
+    // Узлов больше этого - после шага или setCell собирается мусор. Порог -
+    // удвоенное число узлов после прошлой сборки, но не меньше MAX_NODES:
+    // иначе большое живое дерево собиралось бы на каждом шаге, теряя
+    // запомненные результаты
+    size_t gcThreshold;
+
+    Node* root;
+    long long originX; // Координаты левого верхнего угла root
+    long long originY;
+
+    int viewX; // Угол видимой области
+    int viewY;
+    int width;
+    int height;
+    std::set<int> birthRules;
+    std::set<int> survivalRules;
+    unsigned birthMask;
+    unsigned survivalMask;
+    std::string name;
+    long long generation;
+
+    Node* leaf(bool alive) { return alive ? &aliveLeaf : &deadLeaf; }
+    Node* join(Node* nw, Node* ne, Node* sw, Node* se);
+    Node* empty(int level);
+    Node* center(Node* node);
+
+    // Центральный квадрат узла через 2^stepLevel поколений,
+    // stepLevel <= level - 2
+    Node* step(Node* node, int stepLevel);
+    Node* baseStep(Node* node);
+
+    Node* setCell(Node* node, long long x, long long y, bool state);
+
+    // Узел уровня level из живых клеток [begin, end) с координатами от его
+    // левого верхнего угла; клетки переставляются по четвертям. Создаются
+    // только узлы итогового дерева, а не путь от корня на каждую клетку.
+    typedef std::pair<long long, long long> Cell;
+    Node* build(int level, Cell* begin, Cell* end);
+    Node* copyNode(Node* node, std::unordered_map<Node*, Node*>& copies);
+
+    void reset();
+    void expand();
+    void advance(int stepLevel);
+    void collectGarbage();
+    void loadFromFile(const std::string& filename, int threads);
+
+    template <class Callback>
+    void forEachCell(Node* node, long long x, long long y, Callback callback) const;
+
+public:
+    HashLife(int w, int h, const std::string& universeName = "Universe");
+    // threads - число потоков разбора файла
+    HashLife(const std::string& filename, int threads = 1);
+
+    HashLife(const HashLife&) = delete;
+    HashLife& operator=(const HashLife&) = delete;
+
+    // Бросает std::invalid_argument для правил с B0
+    void setRules(const std::set<int>& birth, const std::set<int>& survival) override;
+
+    void setCell(int x, int y, bool state) override;
+    bool getCell(int x, int y) const override;
+    void nextGeneration() override;
+
+    // Раскладывает n по степеням двойки: шаг на 2^k стоит O(k) уровней
+    // дерева, а не 2^k поколений
+    void nextGenerations(long long n) override;
+
+    void setThreads(int) override {}
+
+    void saveToFile(const std::string& filename) const override;
+
+    int getWidth() const override { return width; }
+    int getHeight() const override { return height; }
+    int getViewX() const override { return viewX; }
+    int getViewY() const override { return viewY; }
+    long long getGeneration() const override { return generation; }
+    const std::string& getName() const override { return name; }
+    std::string getRulesString() const override;
+
+    // Число живых клеток на всей плоскости
+    long long getPopulation() const { return root->population; }
+
+    // Число узлов в таблице (для отладки и тестов сборки мусора)
+    size_t getNodeCount() const { return nodes.size(); }
+
+    void clear() override;
+};
+
+#endif
@@ -0,0 +1,173 @@
+#include "LifeEngine.h"
+#include "Universe.h"
+#include "HashLife.h"
+#include "SparseUniverse.h"
+#include "Parser.h"
+#include "FileWriter.h"
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <stdexcept>
+
+std::unique_ptr<LifeEngine> LifeEngine::create(const std::string& engine, const std::string& filename,
+                                               int threads) {
+    if (engine == "universe") {
+        return std::make_unique<Universe>(filename, threads);
+    } else if (engine == "hashlife") {
+        return std::make_unique<HashLife>(filename, threads);
+    } else if (engine == "sparse") {
+        return std::make_unique<SparseUniverse>(filename, threads);
+    }
+    throw std::invalid_argument("Unknown engine: " + engine);
+}
+
+std::unique_ptr<LifeEngine> LifeEngine::create(const std::string& engine, int width, int height,
+                                               const std::string& name) {
+    if (engine == "universe") {
+        return std::make_unique<Universe>(width, height, name);
+    } else if (engine == "hashlife") {
+        return std::make_unique<HashLife>(width, height, name);
+    } else if (engine == "sparse") {
+        return std::make_unique<SparseUniverse>(width, height, name);
+    }
+    throw std::invalid_argument("Unknown engine: " + engine);
+}
+
+std::string LifeEngine::formatRules(const std::set<int>& birth, const std::set<int>& survival) {
+    std::string result = "B";
+    for (int rule : birth) {
+        result += std::to_string(rule);
+    }
+    result += "/S";
+    for (int rule : survival) {
+        result += std::to_string(rule);
+    }
+    return result;
+}
+
+bool LifeEngine::isRleFile(const std::string& filename) {
+    const std::string extension = ".rle";
+    if (filename.size() < extension.size()) {
+        return false;
+    }
+    std::string tail = filename.substr(filename.size() - extension.size());
+    std::transform(tail.begin(), tail.end(), tail.begin(), [](unsigned char c) { return std::tolower(c); });
+    return tail == extension;
+}
+
+void LifeEngine::writeRleHeader(FileWriter& file, long long width, long long height,
+                                long long originX, long long originY) const {
+    file.write("#N " + getName() + "\n");
+    if (originX != 0 || originY != 0) {
+        file.write("#R " + std::to_string(originX) + " " + std::to_string(originY) + "\n");
+    }
+    file.write("x = " + std::to_string(width) + ", y = " + std::to_string(height) +
+               ", rule = " + getRulesString() + "\n");
+}
+
+void LifeEngine::saveCells(const std::string& filename, std::vector<std::pair<long long, long long>>& cells) const {
+    FileWriter file(filename);
+    std::sort(cells.begin(), cells.end());
+    
+    if (isRleFile(filename)) {
+        // Рамка - границы живых клеток, у пустого узора 0 x 0
+        long long minX = 0;
+        long long maxX = -1;
+        long long minY = 0;
+        long long maxY = -1;
+        if (!cells.empty()) {
+            minX = maxX = cells.front().second;
+            minY = cells.front().first;
+            maxY = cells.back().first;
+        }
+        for (const auto& cell : cells) {
+            minX = std::min(minX, cell.second);
+            maxX = std::max(maxX, cell.second);
+        }
+        
+        writeRleHeader(file, maxX - minX + 1, maxY - minY + 1, minX, minY);
+        RleWriter rle(file, minX, minY);
+        for (const auto& cell : cells) {
+            rle.cells(cell.second, cell.first, 1);
+        }
+        rle.finish();
+    } else {
+        file.write("#Life 1.06\n#N " + getName() + "\n#R " + getRulesString() + "\n");
+        for (const auto& cell : cells) {
+            file.writeCell(cell.second, cell.first);
+        }
+    }
+    file.close();
+}
+
+void LifeEngine::loadPattern(const std::string& filename, int threads, bool keepCoordinates,
+                             const std::function<void(const GameConfig& config, int viewX, int viewY,
+                                                      int width, int height)>& prepare,
+                             const std::function<void(int x, int y)>& place) {
+    using Prepare = std::function<void(const GameConfig& config, int viewX, int viewY, int width, int height)>;
+    using Place = std::function<void(int x, int y)>;
+    
+    class EngineSink : public CellSink {
+    public:
+        EngineSink(LifeEngine& engine, bool keepCoordinates, const Prepare& prepare, const Place& place)
+            : engine(engine), keepCoordinates(keepCoordinates), prepare(prepare), place(place),
+              offsetX(0), offsetY(0) {}
+        
+        void begin(const GameConfig& config) override {
+            // У пустого узора границы не заданы (minX > maxX): поле фиксированного
+            // размера с углом в (0, 0), клетки не сдвигаются
+            if (config.minX > config.maxX || config.minY > config.maxY) {
+                const int emptySize = 5;
+                prepare(config, 0, 0, emptySize, emptySize);
+                return;
+            }
+            
+            // Границы с полем в 2 клетки считаются в long long: узор может
+            // лежать у края int
+            const long long margin = 2;
+            long long left = std::max<long long>(INT_MIN, static_cast<long long>(config.minX) - margin);
+            long long top = std::max<long long>(INT_MIN, static_cast<long long>(config.minY) - margin);
+            long long right = std::min<long long>(INT_MAX, static_cast<long long>(config.maxX) + margin);
+            long long bottom = std::min<long long>(INT_MAX, static_cast<long long>(config.maxY) + margin);
+            long long w = right - left + 1;
+            long long h = bottom - top + 1;
+            
+            if (keepCoordinates) {
+                prepare(config, static_cast<int>(left), static_cast<int>(top),
+                        static_cast<int>(std::min<long long>(w, MAX_VIEW_SIZE)),
+                        static_cast<int>(std::min<long long>(h, MAX_VIEW_SIZE)));
+                return;
+            }
+            
+            if (w > INT_MAX || h > INT_MAX) {
+                throw std::length_error("Pattern is too large for a bounded universe");
+            }
+            offsetX = -left;
+            offsetY = -top;
+            prepare(config, 0, 0, static_cast<int>(w), static_cast<int>(h));
+        }
+        
+        void cell(int x, int y) override {
+            int placeX = static_cast<int>(x + offsetX);
+            int placeY = static_cast<int>(y + offsetY);
+            if (place) {
+                place(placeX, placeY);
+            } else {
+                engine.setCell(placeX, placeY, true);
+            }
+        }
+        
+    private:
+        LifeEngine& engine;
+        bool keepCoordinates;
+        const Prepare& prepare;
+        const Place& place;
+        long long offsetX;
+        long long offsetY;
+    };
+    
+    Parser parser;
+    parser.setThreads(threads);
+    EngineSink sink(*this, keepCoordinates, prepare, place);
+    parser.load(filename, sink);
+}
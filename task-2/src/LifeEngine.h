@@ -0,0 +1,92 @@
+#ifndef LIFEENGINE_H
+#define LIFEENGINE_H
+
+#include "GameConfig.h"
+#include <functional>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+class FileWriter;
+
+// Общий интерфейс движков симуляции. GameOfLife и команды работают через
+// него, поэтому движок можно выбрать при запуске (--engine).
+//   universe - тор фиксированного размера, клетки в битовых словах
+//   hashlife - бесконечная плоскость, квадродерево с мемоизацией,
+//              перескакивает 2^k поколений за один шаг
+//   sparse   - бесконечная плоскость из плиток 64x64, хранит только
+//              плитки с живыми клетками
+class LifeEngine {
+public:
+    virtual ~LifeEngine() = default;
+    
+    virtual void setRules(const std::set<int>& birth, const std::set<int>& survival) = 0;
+    virtual void setCell(int x, int y, bool state) = 0;
+    virtual bool getCell(int x, int y) const = 0;
+    virtual void nextGeneration() = 0;
+    virtual void nextGenerations(long long n) = 0;
+    
+    // Число потоков для шагов; движки без параллельного шага его игнорируют
+    virtual void setThreads(int threads) = 0;
+    
+    // Файл с расширением .rle пишется в RLE, остальные - в Life 1.06
+    virtual void saveToFile(const std::string& filename) const = 0;
+    
+    // Видимая область [viewX, viewX + width) x [viewY, viewY + height),
+    // которую печатает GameOfLife. У Universe угол всегда (0, 0).
+    virtual int getWidth() const = 0;
+    virtual int getHeight() const = 0;
+    virtual int getViewX() const { return 0; }
+    virtual int getViewY() const { return 0; }
+    
+    virtual long long getGeneration() const = 0;
+    virtual const std::string& getName() const = 0;
+    virtual std::string getRulesString() const = 0;
+    
+    virtual void clear() = 0;
+    
+    // Создаёт движок по имени ("universe", "hashlife" или "sparse").
+    // Бросает std::invalid_argument для неизвестного имени. threads - число
+    // потоков разбора файла и шагов (как у setThreads).
+    static std::unique_ptr<LifeEngine> create(const std::string& engine, const std::string& filename,
+                                              int threads = 1);
+    static std::unique_ptr<LifeEngine> create(const std::string& engine, int width, int height,
+                                              const std::string& name);
+    
+protected:
+    // Наибольшая сторона видимой области бесконечных движков после загрузки
+    static constexpr int MAX_VIEW_SIZE = 256;
+    
+    // Строка правил вида "B3/S23"
+    static std::string formatRules(const std::set<int>& birth, const std::set<int>& survival);
+    
+    static bool isRleFile(const std::string& filename);
+    
+    // Строки перед телом RLE: имя, угол узора (если не (0, 0)), размер и правила
+    void writeRleHeader(FileWriter& file, long long width, long long height,
+                        long long originX, long long originY) const;
+    
+    // Пишет файл с именем и правилами движка, формат - как у saveToFile.
+    // Клетки заданы парами (y, x) и выводятся построчно, как у Universe.
+    void saveCells(const std::string& filename, std::vector<std::pair<long long, long long>>& cells) const;
+    
+    // Загружает файл Life 1.06 или RLE без промежуточного списка координат.
+    // prepare получает заголовок и видимую область и готовит движок, затем
+    // клетки ставятся через place или, если он не задан, через setCell.
+    // threads - число потоков Parser.
+    //   keepCoordinates = false - область по границам узора плюс поле
+    //       в 2 клетки, клетки сдвигаются в [0, width) x [0, height);
+    //       std::length_error, если узор не помещается в int
+    //   keepCoordinates = true  - клетки остаются на своих координатах,
+    //       область начинается в углу узора с тем же полем, но каждая
+    //       сторона не больше MAX_VIEW_SIZE
+    // Файл без клеток даёт небольшую пустую область в (0, 0).
+    void loadPattern(const std::string& filename, int threads, bool keepCoordinates,
+                     const std::function<void(const GameConfig& config, int viewX, int viewY,
+                                              int width, int height)>& prepare,
+                     const std::function<void(int x, int y)>& place = nullptr);
+};
+
+#endif
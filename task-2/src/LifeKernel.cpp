@@ -0,0 +1,187 @@
+#include "LifeKernel.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define LIFEKERNEL_X86 1
+#endif
+
+
+namespace lifekernel {
+
+namespace {
+
+// Несколько слов рядом, по одному на дорожку. Операторы над вектором GCC
+// переводит в инструкции SSE2 или AVX2. Вектор лежит в структуре и выровнен
+// только по слову, поэтому шаблоны ядра из LifeKernel.h принимают и
+// возвращают его по значению без соглашения о вызовах AVX.
+template <int N>
+struct Lanes {
+    typedef Word Vector __attribute__((vector_size(N * sizeof(Word)), aligned(sizeof(Word)), may_alias));
+    Vector v;
+
+    Lanes operator&(Lanes other) const { return Lanes{v & other.v}; }
+    Lanes operator|(Lanes other) const { return Lanes{v | other.v}; }
+    Lanes operator^(Lanes other) const { return Lanes{v ^ other.v}; }
+    Lanes operator~() const { return Lanes{~v}; }
+    Lanes operator<<(int shift) const { return Lanes{v << shift}; }
+    Lanes operator>>(int shift) const { return Lanes{v >> shift}; }
+    Lanes& operator|=(Lanes other) { v |= other.v; return *this; }
+};
+
+typedef Lanes<2> Vec2;
+typedef Lanes<4> Vec4;
+
+// Невыровненные загрузка и запись (строка выровнена только по Word)
+inline void load(Word& value, const Word* source) {
+    value = *source;
+}
+
+template <int N>
+inline void load(Lanes<N>& value, const Word* source) {
+    value.v = *reinterpret_cast<const typename Lanes<N>::Vector*>(source);
+}
+
+inline void store(Word* target, Word value) {
+    *target = value;
+}
+
+template <int N>
+inline void store(Word* target, Lanes<N> value) {
+    *reinterpret_cast<typename Lanes<N>::Vector*>(target) = value.v;
+}
+
+inline void markChanged(unsigned char* changed, Word diff) {
+    *changed |= diff != 0;
+}
+
+template <int N>
+inline void markChanged(unsigned char* changed, Lanes<N> diff) {
+    for (int lane = 0; lane < N; ++lane) {
+        changed[lane] |= diff.v[lane] != 0;
+    }
+}
+
+// Шаг слов [begin, end) группами по столько слов, сколько вмещает V.
+// Сдвиги на запад и восток берут перенос из соседних слов, загруженных
+// со сдвигом на слово влево и вправо. Возвращает первое слово, не
+// вошедшее в целую группу.
+template <class V, class Rules>
+inline __attribute__((always_inline))
+int stepGroups(const Word* north, const Word* middle, const Word* south,
+               Word* out, unsigned char* changed, int begin, int end, Rules rules) {
+    const int lanes = sizeof(V) / sizeof(Word);
+    const int last = WORD_BITS - 1;
+
+    int w = begin;
+    for (; w + lanes <= end; w += lanes) {
+        V n, m, s, west, east;
+        load(n, north + w);
+        load(m, middle + w);
+        load(s, south + w);
+
+        load(west, north + w - 1);
+        load(east, north + w + 1);
+        V northWest = (n << 1) | (west >> last);
+        V northEast = (n >> 1) | (east << last);
+        load(west, middle + w - 1);
+        load(east, middle + w + 1);
+        V middleWest = (m << 1) | (west >> last);
+        V middleEast = (m >> 1) | (east << last);
+        load(west, south + w - 1);
+        load(east, south + w + 1);
+        V southWest = (s << 1) | (west >> last);
+        V southEast = (s >> 1) | (east << last);
+
+        V next = rules(m, countNeighbors(northWest, n, northEast, middleWest, middleEast,
+                                         southWest, s, southEast));
+        store(out + w, next);
+        markChanged(changed + w, next ^ m);
+    }
+    return w;
+}
+
+template <class Rules>
+void stepPlain(const Word* north, const Word* middle, const Word* south,
+               Word* out, unsigned char* changed, int begin, int end, Rules rules) {
+    stepGroups<Word>(north, middle, south, out, changed, begin, end, rules);
+}
+
+#ifdef LIFEKERNEL_X86
+
+// SSE2 входит в x86-64, атрибут target не нужен
+template <class Rules>
+void stepSse2(const Word* north, const Word* middle, const Word* south,
+              Word* out, unsigned char* changed, int begin, int end, Rules rules) {
+    int w = stepGroups<Vec2>(north, middle, south, out, changed, begin, end, rules);
+    stepGroups<Word>(north, middle, south, out, changed, w, end, rules);
+}
+
+template <class Rules>
+__attribute__((target("avx2")))
+void stepAvx2(const Word* north, const Word* middle, const Word* south,
+              Word* out, unsigned char* changed, int begin, int end, Rules rules) {
+    int w = stepGroups<Vec4>(north, middle, south, out, changed, begin, end, rules);
+    w = stepGroups<Vec2>(north, middle, south, out, changed, w, end, rules);
+    stepGroups<Word>(north, middle, south, out, changed, w, end, rules);
+}
+
+#endif // LIFEKERNEL_X86
+
+Simd& currentSimd() {
+    static Simd simd = bestSimd();
+    return simd;
+}
+
+} // namespace
+
+Simd bestSimd() {
+#ifdef LIFEKERNEL_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return Simd::AVX2;
+    }
+    return Simd::SSE2;
+#else
+    return Simd::NONE;
+#endif
+}
+
+bool setSimd(Simd simd) {
+    if (simd > bestSimd()) {
+        return false;
+    }
+    currentSimd() = simd;
+    return true;
+}
+
+Simd getSimd() {
+    return currentSimd();
+}
+
+template <class Rules>
+void stepWords(const Word* north, const Word* middle, const Word* south,
+               Word* out, unsigned char* changed, int begin, int end, Rules rules) {
+    switch (currentSimd()) {
+#ifdef LIFEKERNEL_X86
+    case Simd::AVX2:
+        stepAvx2(north, middle, south, out, changed, begin, end, rules);
+        return;
+    case Simd::SSE2:
+        stepSse2(north, middle, south, out, changed, begin, end, rules);
+        return;
+#endif
+    default:
+        stepPlain(north, middle, south, out, changed, begin, end, rules);
+        return;
+    }
+}
+
+template void stepWords<MaskRules>(const Word*, const Word*, const Word*,
+                                   Word*, unsigned char*, int, int, MaskRules);
+template void stepWords<ConwayRules>(const Word*, const Word*, const Word*,
+                                     Word*, unsigned char*, int, int, ConwayRules);
+template void stepWords<HighLifeRules>(const Word*, const Word*, const Word*,
+                                       Word*, unsigned char*, int, int, HighLifeRules);
+template void stepWords<SeedsRules>(const Word*, const Word*, const Word*,
+                                    Word*, unsigned char*, int, int, SeedsRules);
+
+}
@@ -0,0 +1,180 @@
+#ifndef LIFEKERNEL_H
+#define LIFEKERNEL_H
+
+#include <set>
+
+// Побитовое ядро шага "Жизни".
+//
+// Строка клеток хранится машинными словами, по клетке на бит (клетка x -
+// бит x % WORD_BITS слова x / WORD_BITS). Функции ниже считают сразу целое
+// слово клеток: восемь битов соседей складываются полными сумматорами в
+// 4-битный счётчик на клетку, который хранится четырьмя битовыми срезами.
+namespace lifekernel {
+
+typedef unsigned long Word;
+
+const int WORD_BITS = sizeof(Word) * 8;
+
+// Слово w строки, где каждая клетка заменена соседом с запада (x - 1).
+// В строке width клеток, края замкнуты (тор).
+inline Word westWord(const Word* row, int w, int rowWords, int width) {
+    int lastBits = width - (rowWords - 1) * WORD_BITS;
+    Word carry = w > 0 ? row[w - 1] >> (WORD_BITS - 1)
+                       : (row[rowWords - 1] >> (lastBits - 1)) & 1;
+    return (row[w] << 1) | carry;
+}
+
+// Слово w строки, где каждая клетка заменена соседом с востока (x + 1)
+inline Word eastWord(const Word* row, int w, int rowWords, int width) {
+    if (w + 1 < rowWords) {
+        return (row[w] >> 1) | (row[w + 1] << (WORD_BITS - 1));
+    }
+    int lastBits = width - (rowWords - 1) * WORD_BITS;
+    return (row[w] >> 1) | ((row[0] & 1) << (lastBits - 1));
+}
+
+// Число соседей для слова клеток: count = s0 + 2*s1 + 4*s2 + 8*s3.
+// Функции ниже - шаблоны по типу слова W, так что те же сумматоры работают
+// и на Word, и на векторных типах SIMD-ядер.
+template <class W>
+struct BasicCount {
+    W s0;
+    W s1;
+    W s2;
+    W s3;
+};
+
+typedef BasicCount<Word> Count;
+
+template <class W>
+inline void fullAdder(W a, W b, W c, W& sum, W& carry) {
+    W ab = a ^ b;
+    sum = ab ^ c;
+    carry = (a & b) | (ab & c);
+}
+
+// Складывает восемь слов соседей для слова клеток
+template <class W>
+inline BasicCount<W> countNeighbors(W northWest, W north, W northEast,
+                                   W west, W east,
+                                   W southWest, W south, W southEast) {
+    W n0, n1, s0, s1;
+    fullAdder(northWest, north, northEast, n0, n1);
+    fullAdder(southWest, south, southEast, s0, s1);
+    W m0 = west ^ east;
+    W m1 = west & east;
+
+    // Единицы: n0 + m0 + s0, перенос уходит в двойки
+    BasicCount<W> count;
+    W carry;
+    fullAdder(n0, m0, s0, count.s0, carry);
+
+    // Двойки: n1 + m1 + s1 + перенос
+    W twos, fours;
+    fullAdder(n1, m1, s1, twos, fours);
+    count.s1 = twos ^ carry;
+    W fours2 = twos & carry;
+
+    count.s2 = fours ^ fours2;
+    count.s3 = fours & fours2;
+    return count;
+}
+
+// Правило в виде маски: бит k установлен для каждого числа соседей k из rules
+inline unsigned ruleMask(const std::set<int>& rules) {
+    unsigned mask = 0;
+    for (int rule : rules) {
+        mask |= 1u << rule;
+    }
+    return mask;
+}
+
+// Следующее состояние слова клеток. Бит k маски birthMask (survivalMask)
+// установлен, если мёртвая (живая) клетка с k соседями оживает (выживает).
+template <class W>
+inline W applyRules(W alive, const BasicCount<W>& count, unsigned birthMask, unsigned survivalMask) {
+    W result = W();
+    for (int k = 0; k <= 8; ++k) {
+        bool birth = (birthMask >> k) & 1;
+        bool survival = (survivalMask >> k) & 1;
+        if (!birth && !survival) {
+            continue;
+        }
+
+        W equal = ((k & 1) ? count.s0 : ~count.s0)
+                & ((k & 2) ? count.s1 : ~count.s1)
+                & ((k & 4) ? count.s2 : ~count.s2)
+                & ((k & 8) ? count.s3 : ~count.s3);
+
+        if (birth && survival) {
+            result |= equal;
+        } else if (birth) {
+            result |= equal & ~alive;
+        } else {
+            result |= equal & alive;
+        }
+    }
+    return result;
+}
+
+// Правила для циклов шага. MaskRules получает маски во время работы, у
+// FixedRules они - параметры шаблона, и applyRules разворачивается в
+// несколько побитовых операций без ветвлений.
+struct MaskRules {
+    unsigned birthMask;
+    unsigned survivalMask;
+
+    template <class W>
+    W operator()(W alive, const BasicCount<W>& count) const {
+        return applyRules(alive, count, birthMask, survivalMask);
+    }
+};
+
+template <unsigned BirthMask, unsigned SurvivalMask>
+struct FixedRules {
+    static constexpr unsigned BIRTH = BirthMask;
+    static constexpr unsigned SURVIVAL = SurvivalMask;
+
+    template <class W>
+    W operator()(W alive, const BasicCount<W>& count) const {
+        return applyRules(alive, count, BirthMask, SurvivalMask);
+    }
+};
+
+typedef FixedRules<(1u << 3) | (1u << 6), (1u << 2) | (1u << 3)> HighLifeRules; // B36/S23
+typedef FixedRules<1u << 2, 0> SeedsRules;                                  // B2/S
+
+// B3/S23: клетка жива, если соседей 3, или 2 у живой клетки
+struct ConwayRules {
+    static constexpr unsigned BIRTH = 1u << 3;
+    static constexpr unsigned SURVIVAL = (1u << 2) | (1u << 3);
+
+    template <class W>
+    W operator()(W alive, const BasicCount<W>& count) const {
+        return count.s1 & ~count.s2 & ~count.s3 & (count.s0 | alive);
+    }
+};
+
+// Шаг слов [begin, end) строки в out, 0 < begin <= end < rowWords: соседи
+// с запада и востока - смежные слова той же строки, замыкать тор не нужно.
+// changed[w] ставится, если слово w отличается от middle[w]. Работает самое
+// широкое векторное ядро, которое есть у процессора (AVX2, SSE2, простые
+// слова), если другое не выбрано через setSimd. Инстанцирован для
+// MaskRules, ConwayRules, HighLifeRules и SeedsRules.
+template <class Rules>
+void stepWords(const Word* north, const Word* middle, const Word* south,
+               Word* out, unsigned char* changed, int begin, int end, Rules rules);
+
+enum class Simd { NONE, SSE2, AVX2 };
+
+// Лучшее ядро, которое поддерживает процессор
+Simd bestSimd();
+
+// Ядро для stepWords; false (без изменений), если процессор его не
+// поддерживает. Для бенчмарков и тестов.
+bool setSimd(Simd simd);
+Simd getSimd();
+
+}
+
+#endif
@@ -1,31 +1,229 @@
 #include "Parser.h"
-#include <fstream>
-#include <sstream>
 #include <iostream>
 #include <algorithm>
+#include <cerrno>
+#include <charconv>
 #include <climits>
 #include <cctype>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// Файл, отображённый в память только для чтения
+class MappedFile {
+private:
+    void* mapping;
+    size_t size;
+    
+public:
+    MappedFile(int fd, size_t fileSize) : mapping(MAP_FAILED), size(fileSize) {
+        if (size > 0) {
+            mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        if (mapping != MAP_FAILED) {
+            ::madvise(mapping, size, MADV_SEQUENTIAL);
+        }
+    }
+    
+    ~MappedFile() {
+        if (mapping != MAP_FAILED) {
+            ::munmap(mapping, size);
+        }
+    }
+    
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    
+    bool valid() const { return mapping != MAP_FAILED; }
+    const char* data() const { return static_cast<const char*>(mapping); }
+};
+
+// Закрывает дескриптор при выходе из parse, в том числе по исключению
+class FileDescriptor {
+private:
+    int fd;
+    
+public:
+    explicit FileDescriptor(int descriptor) : fd(descriptor) {}
+    ~FileDescriptor() {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+    
+    FileDescriptor(const FileDescriptor&) = delete;
+    FileDescriptor& operator=(const FileDescriptor&) = delete;
+    
+    int get() const { return fd; }
+};
+
+// Первый проход load: нужны только границы
+class BoundsOnly : public CellSink {
+public:
+    void begin(const GameConfig&) override {}
+    void cell(int, int) override {}
+};
+
+bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+// Целое число после пробелов, как у operator>>; nullptr при ошибке
+const char* parseInt(const char* pos, const char* end, int& value) {
+    while (pos < end && isBlank(*pos)) {
+        ++pos;
+    }
+    if (pos + 1 < end && *pos == '+' && std::isdigit(static_cast<unsigned char>(pos[1]))) {
+        ++pos;
+    }
+    std::from_chars_result result = std::from_chars(pos, end, value);
+    return result.ec == std::errc() ? result.ptr : nullptr;
+}
+
+bool startsWith(const char* begin, const char* end, const char* prefix) {
+    size_t length = std::strlen(prefix);
+    return static_cast<size_t>(end - begin) >= length && std::memcmp(begin, prefix, length) == 0;
+}
+
+const char* skipBlanks(const char* pos, const char* end) {
+    while (pos < end && isBlank(*pos)) {
+        ++pos;
+    }
+    return pos;
+}
+
+// Правила из RLE: "B3/S23", "b3s23" или старая запись "S/B" вида "23/3".
+// Суффикс Golly после ':' (ограниченное поле, например ":T100,100")
+// отбрасывается: форму поля задаёт движок.
+std::string normalizeRleRules(const std::string& rules) {
+    std::string result;
+    for (char c : rules.substr(0, rules.find(':'))) {
+        if (!isBlank(c)) {
+            result += static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        }
+    }
+    size_t slash = result.find('/');
+    if (result.find('B') == std::string::npos && slash != std::string::npos) {
+        result = "B" + result.substr(slash + 1) + "/S" + result.substr(0, slash);
+    }
+    return result;
+}
+
+enum class Format { UNKNOWN, LIFE, RLE };
+
+// Формат по первой строке вне комментариев. UNKNOWN - в [data, data + size)
+// такой строки ещё нет, а файл не кончился (last == false).
+Format detectFormat(const char* data, size_t size, bool last) {
+    const char* pos = data;
+    const char* end = data + size;
+    while (pos < end) {
+        const char* newline = static_cast<const char*>(std::memchr(pos, '\n', end - pos));
+        if (newline == nullptr && !last) {
+            return Format::UNKNOWN;
+        }
+        const char* lineEnd = newline != nullptr ? newline : end;
+        const char* begin = skipBlanks(pos, lineEnd);
+        if (startsWith(pos, lineEnd, "#Life")) {
+            return Format::LIFE;
+        }
+        if (begin < lineEnd && *pos != '#') {
+            return *begin == 'x' ? Format::RLE : Format::LIFE;
+        }
+        pos = lineEnd < end ? lineEnd + 1 : end;
+    }
+    return last ? Format::LIFE : Format::UNKNOWN;
+}
+
+}
 
 GameConfig Parser::parse(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
+    FileDescriptor fd(::open(filename.c_str(), O_RDONLY));
+    if (fd.get() < 0) {
         throw ParseException("Cannot open file: " + filename);
     }
     
-    std::string content;
-    std::string line;
-    while (std::getline(file, line)) {
-        content += line + "\n";
+    GameConfig config;
+    bool hasFormat = false;
+    startConfig(config);
+    
+    struct stat st;
+    if (::fstat(fd.get(), &st) == 0 && S_ISREG(st.st_mode)) {
+        MappedFile file(fd.get(), static_cast<size_t>(st.st_size));
+        if (file.valid()) {
+            parseWhole(file.data(), static_cast<size_t>(st.st_size), config, hasFormat);
+        } else {
+            parseStream(fd.get(), config, hasFormat);
+        }
+    } else {
+        parseStream(fd.get(), config, hasFormat);
     }
     
-    return parseFromString(content);
+    finishConfig(hasFormat);
+    return config;
 }
 
-GameConfig Parser::parseFromString(const std::string& content) {
+GameConfig Parser::load(const std::string& filename, CellSink& sink) {
+    FileDescriptor fd(::open(filename.c_str(), O_RDONLY));
+    if (fd.get() < 0) {
+        throw ParseException("Cannot open file: " + filename);
+    }
+    
     GameConfig config;
-    std::istringstream stream(content);
-    std::string line;
+    bool hasFormat = false;
+    startConfig(config);
+    
+    struct stat st;
+    if (::fstat(fd.get(), &st) == 0 && S_ISREG(st.st_mode)) {
+        MappedFile file(fd.get(), static_cast<size_t>(st.st_size));
+        if (file.valid()) {
+            BoundsOnly bounds;
+            parseWhole(file.data(), static_cast<size_t>(st.st_size), config, hasFormat, &bounds);
+            finishConfig(hasFormat);
+            sink.begin(config);
+            
+            // Ошибки уже найдены первым проходом; заголовок разбирается заново в копию
+            GameConfig again;
+            bool againFormat = false;
+            startConfig(again);
+            parseSequential(file.data(), static_cast<size_t>(st.st_size), again, againFormat, &sink);
+            return config;
+        }
+    }
+    
+    parseStream(fd.get(), config, hasFormat);
+    finishConfig(hasFormat);
     
+    std::vector<std::pair<int, int>> coordinates;
+    coordinates.swap(config.coordinates);
+    sink.begin(config);
+    for (const auto& coord : coordinates) {
+        sink.cell(coord.first, coord.second);
+    }
+    return config;
+}
+
+GameConfig Parser::parseFromString(const std::string& content) {
+    return parseBuffer(content.data(), content.size());
+}
+
+GameConfig Parser::parseBuffer(const char* data, size_t size) {
+    GameConfig config;
+    bool hasFormat = false;
+    startConfig(config);
+    parseWhole(data, size, config, hasFormat);
+    finishConfig(hasFormat);
+    return config;
+}
+
+void Parser::startConfig(GameConfig& config) {
     config.minX = INT_MAX;
     config.maxX = INT_MIN;
     config.minY = INT_MAX;
@@ -34,35 +232,329 @@ GameConfig Parser::parseFromString(const std::string& content) {
     config.birthRules = {3};
     config.survivalRules = {2, 3};
     config.rulesString = "B3/S23";
+}
+
+void Parser::finishConfig(bool hasFormat) {
+    if (!hasFormat) {
+        throw ParseException("Invalid file format: Missing #Life header");
+    }
+}
+
+// Читает файл кусками; неполная строка в конце куска переносится в начало
+// следующего, так что буфер растёт только под очень длинную строку. Пока
+// формат не ясен, и для RLE, файл дочитывается в буфер без разбора.
+void Parser::parseStream(int fd, GameConfig& config, bool& hasFormat) {
+    std::vector<char> buffer(CHUNK_SIZE);
+    size_t filled = 0;
+    Format format = Format::UNKNOWN;
     
-    bool hasFormat = false;
+    while (true) {
+        if (filled == buffer.size()) {
+            buffer.resize(buffer.size() * 2);
+        }
+        ssize_t bytes = ::read(fd, buffer.data() + filled, buffer.size() - filled);
+        if (bytes < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw ParseException(std::string("Cannot read file: ") + std::strerror(errno));
+        }
+        
+        bool last = bytes == 0;
+        filled += static_cast<size_t>(bytes);
+        if (format == Format::UNKNOWN) {
+            format = detectFormat(buffer.data(), filled, last);
+        }
+        if (format != Format::LIFE) {
+            if (last) {
+                parseRle(buffer.data(), filled, config, hasFormat, nullptr);
+                break;
+            }
+            continue;
+        }
+        
+        size_t used = parseLines(buffer.data(), filled, last, config, hasFormat);
+        if (last) {
+            break;
+        }
+        std::memmove(buffer.data(), buffer.data() + used, filled - used);
+        filled -= used;
+    }
+}
+
+void Parser::setThreads(int threads) {
+    if (threads < 0) {
+        throw std::invalid_argument("Number of threads must be non-negative");
+    }
+    if (threads == 0) {
+        threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
     
-    while (std::getline(stream, line)) {
-        if (line.empty()) continue;
+    if (threads == 1) {
+        pool.reset();
+    } else if (getThreads() != threads) {
+        pool = std::make_shared<ThreadPool>(threads);
+    }
+}
+
+void Parser::parseWhole(const char* data, size_t size, GameConfig& config, bool& hasFormat,
+                        CellSink* sink) {
+    if (pool && size >= PARALLEL_MIN_BYTES && detectFormat(data, size, true) == Format::LIFE) {
+        parseParallel(data, size, config, hasFormat, sink);
+    } else {
+        parseSequential(data, size, config, hasFormat, sink);
+    }
+}
+
+void Parser::parseSequential(const char* data, size_t size, GameConfig& config, bool& hasFormat,
+                             CellSink* sink) {
+    if (detectFormat(data, size, true) == Format::RLE) {
+        parseRle(data, size, config, hasFormat, sink);
+    } else {
+        parseLines(data, size, true, config, hasFormat, nullptr, sink);
+    }
+}
+
+// Буфер делится на части, каждая кончается переводом строки. Первая часть
+// разбирается прямо в config, остальные - в свои GameConfig, а их строки '#'
+// откладываются и применяются при слиянии в порядке файла. Ошибка тоже
+// берётся из самой ранней части с ошибкой. sink вызывается из разных потоков.
+void Parser::parseParallel(const char* data, size_t size, GameConfig& config, bool& hasFormat,
+                           CellSink* sink) {
+    struct Part {
+        GameConfig config;
+        std::vector<std::string> headers;
+        std::exception_ptr error;
+    };
+    
+    size_t partCount = static_cast<size_t>(pool->size()) * 4;
+    std::vector<size_t> bounds(partCount + 1, size);
+    bounds[0] = 0;
+    for (size_t i = 1; i < partCount; ++i) {
+        size_t pos = std::max(bounds[i - 1], size / partCount * i);
+        const void* newline = pos < size ? std::memchr(data + pos, '\n', size - pos) : nullptr;
+        bounds[i] = newline != nullptr ? static_cast<const char*>(newline) - data + 1 : size;
+    }
+    
+    std::vector<Part> parts(partCount);
+    pool->parallel_for(partCount, 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            Part& part = parts[i];
+            try {
+                if (i == 0) {
+                    parseLines(data, bounds[1], true, config, hasFormat, nullptr, sink);
+                } else {
+                    bool partFormat = false;
+                    startConfig(part.config);
+                    parseLines(data + bounds[i], bounds[i + 1] - bounds[i], true, part.config, partFormat,
+                               &part.headers, sink);
+                }
+            } catch (...) {
+                part.error = std::current_exception();
+            }
+        }
+    });
+    
+    size_t total = 0;
+    for (const Part& part : parts) {
+        total += part.config.coordinates.size();
+    }
+    config.coordinates.reserve(config.coordinates.size() + total);
+    
+    for (size_t i = 0; i < partCount; ++i) {
+        Part& part = parts[i];
+        for (const std::string& header : part.headers) {
+            parseLine(header.data(), header.data() + header.size(), config, hasFormat, nullptr, nullptr);
+        }
+        if (part.error) {
+            std::rethrow_exception(part.error);
+        }
+        // Первая часть разобрана прямо в config, её parts[0].config не заполнялся
+        if (i > 0 && part.config.minX <= part.config.maxX) {
+            config.coordinates.insert(config.coordinates.end(),
+                                      part.config.coordinates.begin(), part.config.coordinates.end());
+            updateBounds(part.config.minX, part.config.minY, config);
+            updateBounds(part.config.maxX, part.config.maxY, config);
+            std::vector<std::pair<int, int>>().swap(part.config.coordinates);
+        }
+    }
+}
+
+size_t Parser::parseLines(const char* data, size_t size, bool last, GameConfig& config, bool& hasFormat,
+                          std::vector<std::string>* headers, CellSink* sink) {
+    const char* pos = data;
+    const char* end = data + size;
+    
+    while (pos < end) {
+        const char* newline = static_cast<const char*>(std::memchr(pos, '\n', end - pos));
+        if (newline == nullptr) {
+            if (!last) {
+                break;
+            }
+            newline = end;
+        }
+        parseLine(pos, newline, config, hasFormat, headers, sink);
+        pos = newline < end ? newline + 1 : end;
+    }
+    return pos - data;
+}
+
+void Parser::parseLine(const char* begin, const char* end, GameConfig& config, bool& hasFormat,
+                       std::vector<std::string>* headers, CellSink* sink) {
+    // Строки из Windows заканчиваются на "\r\n"
+    if (end > begin && end[-1] == '\r') {
+        --end;
+    }
+    if (begin == end) {
+        return;
+    }
+    
+    if (*begin != '#') {
+        parseCoordinates(begin, end, config, sink);
+    } else if (headers != nullptr) {
+        headers->emplace_back(begin, end);
+    } else if (startsWith(begin, end, "#Life 1.")) {
+        parseFormat(std::string(begin, end), config);
+        hasFormat = true;
+    } else if (startsWith(begin, end, "#N ")) {
+        parseName(std::string(begin, end), config);
+    } else if (startsWith(begin, end, "#R ")) {
+        parseRules(std::string(begin, end), config);
+    } else if (!startsWith(begin, end, "# ")) {
+        std::cout << "Warning: Unknown comment line: " << std::string(begin, end) << std::endl;
+    }
+}
+
+void Parser::parseRle(const char* data, size_t size, GameConfig& config, bool& hasFormat, CellSink* sink) {
+    const char* pos = data;
+    const char* end = data + size;
+    long long originX = 0;
+    long long originY = 0;
+    
+    // Строки '#' до заголовка: #N имя, #r правила, #R или #P - левый верхний
+    // угол узора; остальные (#C, #O, ...) - комментарии
+    while (pos < end && !hasFormat) {
+        const char* newline = static_cast<const char*>(std::memchr(pos, '\n', end - pos));
+        const char* begin = pos;
+        const char* lineEnd = newline != nullptr ? newline : end;
+        pos = newline != nullptr ? newline + 1 : end;
+        if (lineEnd > begin && lineEnd[-1] == '\r') {
+            --lineEnd;
+        }
         
-        if (line[0] == '#') {
-            if (line.substr(0, 8) == "#Life 1.") {
-                parseFormat(line, config);
-                hasFormat = true;
-            } else if (line.substr(0, 3) == "#N ") {
-                parseName(line, config);
-            } else if (line.substr(0, 3) == "#R ") {
-                parseRules(line, config);
-            } else if (line.substr(0, 2) == "# ") {
-                continue;
-            } else {
-                std::cout << "Warning: Unknown comment line: " << line << std::endl;
+        if (begin < lineEnd && *begin == '#') {
+            if (startsWith(begin, lineEnd, "#N ")) {
+                parseName(std::string(begin, lineEnd), config);
+            } else if (startsWith(begin, lineEnd, "#r ")) {
+                parseRuleString(normalizeRleRules(std::string(begin + 3, lineEnd)), config);
+            } else if (startsWith(begin, lineEnd, "#R ") || startsWith(begin, lineEnd, "#P ")) {
+                int x, y;
+                const char* next = parseInt(begin + 3, lineEnd, x);
+                if (next == nullptr || parseInt(next, lineEnd, y) == nullptr) {
+                    throw ParseException("Invalid RLE offset: " + std::string(begin, lineEnd));
+                }
+                originX = x;
+                originY = y;
+            }
+        } else if (skipBlanks(begin, lineEnd) < lineEnd) {
+            parseRleHeader(begin, lineEnd, config);
+            hasFormat = true;
+        }
+    }
+    if (!hasFormat) {
+        throw ParseException("Invalid RLE format: Missing header line");
+    }
+    
+    // Тело: число перед тегом - длина серии (по умолчанию 1), пробелы и
+    // переводы строк между сериями ничего не значат
+    long long x = 0;
+    long long y = 0;
+    long long count = 0;
+    for (; pos < end; ++pos) {
+        char c = *pos;
+        if (c >= '0' && c <= '9') {
+            count = count * 10 + (c - '0');
+            if (count > INT_MAX) {
+                throw ParseException("Invalid RLE run length");
+            }
+            continue;
+        }
+        if (c == '\n' || isBlank(c)) {
+            continue;
+        }
+        
+        long long run = count > 0 ? count : 1;
+        count = 0;
+        if (c == 'b' || c == '.') {
+            x += run;
+        } else if (c == 'o') {
+            long long first = originX + x;
+            long long last = first + run - 1;
+            if (last > INT_MAX || originY + y > INT_MAX) {
+                throw ParseException("RLE pattern is too large");
+            }
+            int row = static_cast<int>(originY + y);
+            for (long long cellX = first; cellX <= last; ++cellX) {
+                if (sink != nullptr) {
+                    sink->cell(static_cast<int>(cellX), row);
+                } else {
+                    config.coordinates.emplace_back(static_cast<int>(cellX), row);
+                }
             }
+            updateBounds(static_cast<int>(first), row, config);
+            updateBounds(static_cast<int>(last), row, config);
+            x += run;
+        } else if (c == '$') {
+            y += run;
+            x = 0;
+        } else if (c == '!') {
+            return;
         } else {
-            parseCoordinates(line, config);
+            throw ParseException("Invalid RLE character: " + std::string(1, c));
         }
     }
+}
+
+// "x = 3, y = 3, rule = B3/S23": x и y обязательны, rule - нет
+void Parser::parseRleHeader(const char* begin, const char* end, GameConfig& config) {
+    config.format = "RLE";
+    bool hasX = false;
+    bool hasY = false;
     
-    if (!hasFormat) {
-        throw ParseException("Invalid file format: Missing #Life header");
+    const char* pos = begin;
+    while (pos < end) {
+        const char* comma = static_cast<const char*>(std::memchr(pos, ',', end - pos));
+        const char* itemEnd = comma != nullptr ? comma : end;
+        const char* equals = static_cast<const char*>(std::memchr(pos, '=', itemEnd - pos));
+        if (equals == nullptr) {
+            throw ParseException("Invalid RLE header: " + std::string(begin, end));
+        }
+        
+        const char* keyBegin = skipBlanks(pos, equals);
+        const char* keyEnd = equals;
+        while (keyEnd > keyBegin && isBlank(keyEnd[-1])) {
+            --keyEnd;
+        }
+        std::string key(keyBegin, keyEnd);
+        
+        if (key == "x" || key == "y") {
+            int value;
+            const char* next = parseInt(equals + 1, itemEnd, value);
+            if (next == nullptr || skipBlanks(next, itemEnd) != itemEnd || value < 0) {
+                throw ParseException("Invalid RLE header: " + std::string(begin, end));
+            }
+            (key == "x" ? hasX : hasY) = true;
+        } else if (key == "rule") {
+            // Правило идёт последним и может содержать запятые (":T100,100")
+            parseRuleString(normalizeRleRules(std::string(equals + 1, end)), config);
+            break;
+        }
+        pos = comma != nullptr ? comma + 1 : end;
     }
     
-    return config;
+    if (!hasX || !hasY) {
+        throw ParseException("Invalid RLE header: " + std::string(begin, end));
+    }
 }
 
 void Parser::parseFormat(const std::string& line, GameConfig& config) {
@@ -74,8 +566,10 @@ void Parser::parseName(const std::string& line, GameConfig& config) {
 }
 
 void Parser::parseRules(const std::string& line, GameConfig& config) {
-    std::string rulesStr = line.substr(3);
-    
+    parseRuleString(line.substr(3), config);
+}
+
+void Parser::parseRuleString(const std::string& rulesStr, GameConfig& config) {
     size_t bPos = rulesStr.find('B');
     size_t sPos = rulesStr.find('S');
     size_t slashPos = rulesStr.find('/');
@@ -110,15 +604,22 @@ void Parser::parseRules(const std::string& line, GameConfig& config) {
     config.rulesString = rulesStr;
 }
 
-void Parser::parseCoordinates(const std::string& line, GameConfig& config) {
-    std::istringstream iss(line);
+void Parser::parseCoordinates(const char* begin, const char* end, GameConfig& config, CellSink* sink) {
     int x, y;
+    const char* pos = parseInt(begin, end, x);
+    if (pos != nullptr) {
+        pos = parseInt(pos, end, y);
+    }
     
-    if (iss >> x >> y) {
-        config.coordinates.emplace_back(x, y);
+    if (pos != nullptr) {
+        if (sink != nullptr) {
+            sink->cell(x, y);
+        } else {
+            config.coordinates.emplace_back(x, y);
+        }
         updateBounds(x, y, config);
     } else {
-        throw ParseException("Invalid coordinate format: " + line);
+        throw ParseException("Invalid coordinate format: " + std::string(begin, end));
     }
 }
 
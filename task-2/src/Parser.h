@@ -2,19 +2,86 @@
 #define PARSER_H
 
 #include "GameConfig.h"
+#include "ThreadPool.h"
+#include <cstddef>
+#include <memory>
 #include <string>
+#include <vector>
 #include <exception>
 
+// Получатель клеток при загрузке файла без списка координат (Parser::load)
+class CellSink {
+public:
+    virtual ~CellSink() = default;
+    
+    // Вызывается один раз до всех cell: заголовок и границы узора уже
+    // известны, config.coordinates пуст
+    virtual void begin(const GameConfig& config) = 0;
+    virtual void cell(int x, int y) = 0;
+};
+
+// Разбор файлов Life 1.06 и RLE; формат определяется по заголовку: первая
+// строка вне комментариев вида "x = ..." - RLE, иначе Life 1.06.
+// Строки разбираются прямо в буфере: обычный файл
+// отображается в память (mmap), остальные (каналы и т.п.) читаются кусками
+// по CHUNK_SIZE байт. Координаты читаются std::from_chars, границы узора
+// обновляются по ходу, копии всего файла в памяти не создаётся.
+//
+// С несколькими потоками буфер от PARALLEL_MIN_BYTES байт делится по
+// переводам строк на части, которые разбираются параллельно и сливаются
+// по порядку; результат тот же, что и при разборе в одном потоке. RLE
+// всегда разбирается в одном потоке: серии переходят через строки.
 class Parser {
+private:
+    std::shared_ptr<ThreadPool> pool; // nullptr - разбор в одном потоке
+    
 public:
+    static constexpr size_t CHUNK_SIZE = 1 << 20;
+    static constexpr size_t PARALLEL_MIN_BYTES = 1 << 22;
+    
     GameConfig parse(const std::string& filename);
     GameConfig parseFromString(const std::string& content);
+    GameConfig parseBuffer(const char* data, size_t size);
+    
+    // Загрузка в два прохода: первый проверяет файл и находит границы,
+    // второй передаёт клетки в sink по порядку файла. Координаты нигде не
+    // копятся, кроме файлов, которые не отображаются в память: их нельзя
+    // прочитать дважды. Возвращает заголовок и границы без координат.
+    GameConfig load(const std::string& filename, CellSink& sink);
+    
+    // Число потоков разбора: 1 - последовательно, 0 - по числу ядер.
+    // Файлы, которые не отображаются в память, всегда читаются в одном потоке.
+    void setThreads(int threads);
+    int getThreads() const { return pool ? static_cast<int>(pool->size()) : 1; }
     
 private:
+    void startConfig(GameConfig& config);
+    void finishConfig(bool hasFormat);
+    void parseStream(int fd, GameConfig& config, bool& hasFormat);
+    void parseWhole(const char* data, size_t size, GameConfig& config, bool& hasFormat,
+                    CellSink* sink = nullptr);
+    void parseParallel(const char* data, size_t size, GameConfig& config, bool& hasFormat, CellSink* sink);
+    void parseSequential(const char* data, size_t size, GameConfig& config, bool& hasFormat, CellSink* sink);
+    
+    // Файл RLE целиком: строки '#', заголовок "x = , y = , rule = " и тело
+    // из серий <число><b|o|$> до '!'. Живые клетки - как у parseCoordinates.
+    void parseRle(const char* data, size_t size, GameConfig& config, bool& hasFormat, CellSink* sink);
+    void parseRleHeader(const char* begin, const char* end, GameConfig& config);
+    
+    // Разбирает строки [data, data + size). Если last == false, неполная
+    // последняя строка (без '\n') остаётся; возвращает число разобранных байт.
+    // Если headers не nullptr, строки '#' не применяются, а копятся в нём.
+    // Координаты идут в sink, а без него - в config.coordinates.
+    size_t parseLines(const char* data, size_t size, bool last, GameConfig& config, bool& hasFormat,
+                      std::vector<std::string>* headers = nullptr, CellSink* sink = nullptr);
+    void parseLine(const char* begin, const char* end, GameConfig& config, bool& hasFormat,
+                   std::vector<std::string>* headers, CellSink* sink);
+    
     void parseFormat(const std::string& line, GameConfig& config);
     void parseName(const std::string& line, GameConfig& config);
     void parseRules(const std::string& line, GameConfig& config);
-    void parseCoordinates(const std::string& line, GameConfig& config);
+    void parseRuleString(const std::string& rulesStr, GameConfig& config);
+    void parseCoordinates(const char* begin, const char* end, GameConfig& config, CellSink* sink);
     void updateBounds(int x, int y, GameConfig& config);
 };
 
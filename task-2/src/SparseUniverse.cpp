@@ -0,0 +1,255 @@
+#include "SparseUniverse.h"
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+using lifekernel::Word;
+
+SparseUniverse::SparseUniverse(int w, int h, const std::string& universeName)
+    : viewX(0), viewY(0), width(w), height(h), name(universeName), generation(0) {
+    setRules({3}, {2, 3});
+}
+
+SparseUniverse::SparseUniverse(const std::string& filename, int threads) : SparseUniverse(0, 0) {
+    loadFromFile(filename, threads);
+}
+
+// Координаты и видимая область - как у Universe, загруженной из того же файла
+void SparseUniverse::loadFromFile(const std::string& filename, int threads) {
+    loadPattern(filename, threads, true, [this](const GameConfig& config, int x, int y, int w, int h) {
+        setRules(config.birthRules, config.survivalRules);
+        name = config.name;
+        viewX = x;
+        viewY = y;
+        width = w;
+        height = h;
+    });
+}
+
+SparseUniverse::TileKey SparseUniverse::makeKey(int tx, int ty) {
+    return (static_cast<TileKey>(static_cast<uint32_t>(tx)) << 32) | static_cast<uint32_t>(ty);
+}
+
+const SparseUniverse::Tile* SparseUniverse::findTile(int tx, int ty) const {
+    auto found = tiles.find(makeKey(tx, ty));
+    return found != tiles.end() ? &found->second : nullptr;
+}
+
+void SparseUniverse::setRules(const std::set<int>& birth, const std::set<int>& survival) {
+    if (birth.count(0) > 0) {
+        throw std::invalid_argument("Sparse universe does not support rules with B0");
+    }
+
+    birthRules = birth;
+    survivalRules = survival;
+    birthMask = lifekernel::ruleMask(birthRules);
+    survivalMask = lifekernel::ruleMask(survivalRules);
+    markAllChanged();
+}
+
+// Без B0 новые клетки появляются только рядом с живыми, поэтому в качестве
+// изменений достаточно самих плиток
+void SparseUniverse::markAllChanged() {
+    for (const auto& entry : tiles) {
+        changedTiles[entry.first] = entry.second;
+    }
+}
+
+void SparseUniverse::setCell(int x, int y, bool state) {
+    TileKey key = makeKey(floorDiv(x), floorDiv(y));
+    int row = y - floorDiv(y) * TILE_SIZE;
+    Word bit = Word(1) << (x - floorDiv(x) * TILE_SIZE);
+
+    auto found = tiles.find(key);
+    if (found == tiles.end()) {
+        if (state) {
+            Tile& tile = tiles[key];
+            tile = Tile{};
+            tile.rows[row] = bit;
+            changedTiles[key].rows[row] |= bit;
+        }
+        return;
+    }
+
+    Tile& tile = found->second;
+    if (((tile.rows[row] & bit) != 0) == state) {
+        return;
+    }
+    changedTiles[key].rows[row] |= bit;
+    tile.rows[row] = state ? (tile.rows[row] | bit) : (tile.rows[row] & ~bit);
+    if (!state) {
+        Word any = 0;
+        for (Word word : tile.rows) {
+            any |= word;
+        }
+        if (any == 0) {
+            tiles.erase(found);
+        }
+    }
+}
+
+bool SparseUniverse::getCell(int x, int y) const {
+    const Tile* tile = findTile(floorDiv(x), floorDiv(y));
+    if (tile == nullptr) {
+        return false;
+    }
+    int row = y - floorDiv(y) * TILE_SIZE;
+    return (tile->rows[row] >> (x - floorDiv(x) * TILE_SIZE)) & 1;
+}
+
+void SparseUniverse::addCandidates(TileKey key, const Tile& tile) {
+    candidates.insert(key);
+
+    Word west = 0;
+    Word east = 0;
+    for (Word word : tile.rows) {
+        west |= word & 1;
+        east |= word >> (TILE_SIZE - 1);
+    }
+    Word north = tile.rows[0];
+    Word south = tile.rows[TILE_SIZE - 1];
+
+    int tx = tileX(key);
+    int ty = tileY(key);
+    if (north != 0) candidates.insert(makeKey(tx, ty - 1));
+    if (south != 0) candidates.insert(makeKey(tx, ty + 1));
+    if (west != 0) candidates.insert(makeKey(tx - 1, ty));
+    if (east != 0) candidates.insert(makeKey(tx + 1, ty));
+    if (north & 1) candidates.insert(makeKey(tx - 1, ty - 1));
+    if (north >> (TILE_SIZE - 1)) candidates.insert(makeKey(tx + 1, ty - 1));
+    if (south & 1) candidates.insert(makeKey(tx - 1, ty + 1));
+    if (south >> (TILE_SIZE - 1)) candidates.insert(makeKey(tx + 1, ty + 1));
+}
+
+// Строки плитки с соседними строками сверху и снизу складываются тем же
+// побитовым ядром, что и в Universe; сдвиги берут крайние биты соседних плиток
+bool SparseUniverse::stepTile(TileKey key, Tile& out) const {
+    static const Tile emptyTile = {};
+
+    int tx = tileX(key);
+    int ty = tileY(key);
+    const Tile* around[3][3];
+    for (int dy = -1; dy <= 1; ++dy) {
+        for (int dx = -1; dx <= 1; ++dx) {
+            const Tile* tile = findTile(tx + dx, ty + dy);
+            around[dy + 1][dx + 1] = tile != nullptr ? tile : &emptyTile;
+        }
+    }
+
+    // Строки -1 .. TILE_SIZE: сама строка и её сдвиги на запад и восток
+    Word middle[TILE_SIZE + 2];
+    Word west[TILE_SIZE + 2];
+    Word east[TILE_SIZE + 2];
+    for (int i = 0; i < TILE_SIZE + 2; ++i) {
+        int row = i - 1;
+        int band = row < 0 ? 0 : (row < TILE_SIZE ? 1 : 2);
+        int r = (row + TILE_SIZE) % TILE_SIZE;
+        Word center = around[band][1]->rows[r];
+        middle[i] = center;
+        west[i] = (center << 1) | (around[band][0]->rows[r] >> (TILE_SIZE - 1));
+        east[i] = (center >> 1) | (around[band][2]->rows[r] << (TILE_SIZE - 1));
+    }
+
+    Word any = 0;
+    for (int row = 0; row < TILE_SIZE; ++row) {
+        int i = row + 1;
+        lifekernel::Count count = lifekernel::countNeighbors(
+            west[i - 1], middle[i - 1], east[i - 1],
+            west[i], east[i],
+            west[i + 1], middle[i + 1], east[i + 1]);
+        out.rows[row] = lifekernel::applyRules(middle[i], count, birthMask, survivalMask);
+        any |= out.rows[row];
+    }
+    return any != 0;
+}
+
+// Плитка, у которой ни она сама, ни примыкающие клетки соседей не менялись,
+// в следующем поколении останется прежней. Поэтому пересчитываются только
+// кандидаты от изменений, а в tiles переписываются лишь изменившиеся плитки.
+void SparseUniverse::nextGeneration() {
+    static const Tile emptyTile = {};
+
+    candidates.clear();
+    for (const auto& entry : changedTiles) {
+        addCandidates(entry.first, entry.second);
+    }
+    changedTiles.clear();
+
+    // Сначала считаются все кандидаты: stepTile читает tiles
+    nextTiles.clear();
+    Tile next;
+    for (TileKey key : candidates) {
+        if (stepTile(key, next) || tiles.count(key) > 0) {
+            nextTiles.emplace(key, next);
+        }
+    }
+
+    for (const auto& entry : nextTiles) {
+        auto found = tiles.find(entry.first);
+        const Tile& old = found != tiles.end() ? found->second : emptyTile;
+
+        Tile diff;
+        Word changed = 0;
+        Word alive = 0;
+        for (int row = 0; row < TILE_SIZE; ++row) {
+            diff.rows[row] = old.rows[row] ^ entry.second.rows[row];
+            changed |= diff.rows[row];
+            alive |= entry.second.rows[row];
+        }
+        if (changed == 0) {
+            continue;
+        }
+
+        changedTiles.emplace(entry.first, diff);
+        if (alive == 0) {
+            tiles.erase(found);
+        } else if (found != tiles.end()) {
+            found->second = entry.second;
+        } else {
+            tiles.emplace(entry.first, entry.second);
+        }
+    }
+
+    generation++;
+}
+
+void SparseUniverse::nextGenerations(long long n) {
+    for (long long i = 0; i < n; ++i) {
+        nextGeneration();
+    }
+}
+
+void SparseUniverse::saveToFile(const std::string& filename) const {
+    std::vector<std::pair<long long, long long>> cells;
+    for (const auto& entry : tiles) {
+        long long baseX = static_cast<long long>(tileX(entry.first)) * TILE_SIZE;
+        long long baseY = static_cast<long long>(tileY(entry.first)) * TILE_SIZE;
+        for (int row = 0; row < TILE_SIZE; ++row) {
+            for (Word word = entry.second.rows[row]; word != 0; word &= word - 1) {
+                cells.emplace_back(baseY + row, baseX + __builtin_ctzl(word));
+            }
+        }
+    }
+    saveCells(filename, cells);
+}
+
+std::string SparseUniverse::getRulesString() const {
+    return formatRules(birthRules, survivalRules);
+}
+
+long long SparseUniverse::getPopulation() const {
+    long long population = 0;
+    for (const auto& entry : tiles) {
+        for (Word word : entry.second.rows) {
+            population += __builtin_popcountl(word);
+        }
+    }
+    return population;
+}
+
+void SparseUniverse::clear() {
+    tiles.clear();
+    nextTiles.clear();
+    changedTiles.clear();
+    generation = 0;
+}
@@ -0,0 +1,103 @@
+#ifndef SPARSEUNIVERSE_H
+#define SPARSEUNIVERSE_H
+
+#include "LifeEngine.h"
+#include "LifeKernel.h"
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+// Бесконечная плоскость из квадратных плиток TILE_SIZE x TILE_SIZE клеток
+// (по слову на строку плитки). Хранятся только плитки с живыми клетками,
+// поэтому узоры с координатами в миллионах не требуют огромной сетки.
+//
+// За поколение пересчитываются только плитки, изменившиеся в прошлом
+// поколении (или через setCell), а также их соседи, к которым примыкает
+// изменённая клетка на краю: остальные плитки заведомо останутся прежними,
+// поэтому натюрморты после первого шага не стоят ничего. Правила с B0 не
+// поддерживаются.
+class SparseUniverse : public LifeEngine {
+private:
+    typedef lifekernel::Word Word;
+    typedef uint64_t TileKey; // Упакованные координаты плитки (tx, ty)
+
+    static const int TILE_SIZE = lifekernel::WORD_BITS;
+
+    struct Tile {
+        Word rows[TILE_SIZE];
+    };
+
+    std::unordered_map<TileKey, Tile> tiles;
+    std::unordered_map<TileKey, Tile> nextTiles;    // Новые состояния пересчитанных плиток
+    std::unordered_set<TileKey> candidates;         // Плитки для пересчёта
+    std::unordered_map<TileKey, Tile> changedTiles; // Изменившиеся клетки (старое ^ новое)
+
+    int viewX; // Угол видимой области
+    int viewY;
+    int width;
+    int height;
+    std::set<int> birthRules;
+    std::set<int> survivalRules;
+    unsigned birthMask;
+    unsigned survivalMask;
+    std::string name;
+    long long generation;
+
+    static TileKey makeKey(int tx, int ty);
+    static int tileX(TileKey key) { return static_cast<int32_t>(key >> 32); }
+    static int tileY(TileKey key) { return static_cast<int32_t>(key & 0xffffffffu); }
+    static int floorDiv(int value) { return value >= 0 ? value / TILE_SIZE : -((-(value + 1)) / TILE_SIZE) - 1; }
+
+    const Tile* findTile(int tx, int ty) const;
+
+    // Добавляет плитку и тех соседей, к которым примыкают клетки tile
+    // (живые или изменившиеся)
+    void addCandidates(TileKey key, const Tile& tile);
+
+    // Помечает все плитки изменившимися, например после смены правил
+    void markAllChanged();
+
+    // Считает следующее поколение плитки, возвращает false для пустой
+    bool stepTile(TileKey key, Tile& out) const;
+
+    void loadFromFile(const std::string& filename, int threads);
+
+public:
+    SparseUniverse(int w, int h, const std::string& universeName = "Universe");
+    // threads - число потоков разбора файла
+    SparseUniverse(const std::string& filename, int threads = 1);
+
+    // Бросает std::invalid_argument для правил с B0
+    void setRules(const std::set<int>& birth, const std::set<int>& survival) override;
+
+    void setCell(int x, int y, bool state) override;
+    bool getCell(int x, int y) const override;
+    void nextGeneration() override;
+    void nextGenerations(long long n) override;
+
+    void setThreads(int) override {}
+
+    void saveToFile(const std::string& filename) const override;
+
+    int getWidth() const override { return width; }
+    int getHeight() const override { return height; }
+    int getViewX() const override { return viewX; }
+    int getViewY() const override { return viewY; }
+    long long getGeneration() const override { return generation; }
+    const std::string& getName() const override { return name; }
+    std::string getRulesString() const override;
+
+    // Число живых клеток и выделенных плиток
+    long long getPopulation() const;
+    size_t getTileCount() const { return tiles.size(); }
+
+    // Число плиток, которые изменились за последнее поколение
+    size_t getChangedTileCount() const { return changedTiles.size(); }
+
+    void clear() override;
+};
+
+#endif
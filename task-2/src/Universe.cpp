@@ -1,167 +1,299 @@
 #include "Universe.h"
-#include "Parser.h"
-#include <fstream>
+#include "LifeKernel.h"
+#include "FileWriter.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
 #include <iostream>
+#include <stdexcept>
+
+using lifekernel::Word;
+using lifekernel::WORD_BITS;
 
 Universe::Universe(int w, int h, const std::string& universeName) 
     : width(w), height(h), name(universeName), generation(0) {
-    grid.resize(height, std::vector<bool>(width, false));
+    allocateGrid();
     
     birthRules = {3};
     survivalRules = {2, 3};
+    compileRules();
 }
 
-Universe::Universe(const std::string& filename) {
-    Parser parser;
-    GameConfig config = parser.parse(filename);
-    
-    name = config.name;
-    birthRules = config.birthRules;
-    survivalRules = config.survivalRules;
-    generation = 0;
-    
-    width = (config.maxX - config.minX + 1) + 4;
-    height = (config.maxY - config.minY + 1) + 4;
-    int offsetX = -config.minX + 2;
-    int offsetY = -config.minY + 2;
-    
-    grid.resize(height, std::vector<bool>(width, false));
+Universe::Universe(const std::string& filename, int threads) : Universe(0, 0) {
+    setThreads(threads);
+    loadFromFile(filename);
+}
+
+void Universe::allocateGrid() {
+    if (width < 0 || height < 0) {
+        throw std::invalid_argument("Universe size must be non-negative");
+    }
     
-    for (const auto& coord : config.coordinates) {
-        int x = coord.first + offsetX;
-        int y = coord.second + offsetY;
-        if (x >= 0 && x < width && y >= 0 && y < height) {
-            grid[y][x] = true;
-        }
+    rowWords = (width + WORD_BITS - 1) / WORD_BITS;
+    long long bits = static_cast<long long>(height) * rowWords * WORD_BITS;
+    if (bits > INT_MAX) {
+        throw std::length_error("Universe is too large");
     }
+    cells = BitArray(static_cast<int>(bits));
+    nextCells = BitArray(static_cast<int>(bits));
+    
+    tileRows = (height + TILE_ROWS - 1) / TILE_ROWS;
+    size_t tiles = static_cast<size_t>(tileRows) * rowWords;
+    changedTiles.assign(tiles, 1);
+    nextChangedTiles.assign(tiles, 0);
+    activeTiles.assign(tiles, 0);
+    skippedTiles = 0;
 }
 
 void Universe::setRules(const std::set<int>& birth, const std::set<int>& survival) {
     birthRules = birth;
     survivalRules = survival;
+    compileRules();
+    markAllChanged();
+}
+
+// Правила переводятся в маски один раз, а не на каждом поколении
+void Universe::compileRules() {
+    birthMask = lifekernel::ruleMask(birthRules);
+    survivalMask = lifekernel::ruleMask(survivalRules);
 }
 
 void Universe::setCell(int x, int y, bool state) {
     if (x >= 0 && x < width && y >= 0 && y < height) {
-        grid[y][x] = state;
+        Word bit = Word(1) << (x % WORD_BITS);
+        Word& word = row(y)[x / WORD_BITS];
+        word = state ? (word | bit) : (word & ~bit);
+        changedTiles[static_cast<size_t>(y / TILE_ROWS) * rowWords + x / WORD_BITS] = 1;
     }
 }
 
 bool Universe::getCell(int x, int y) const {
     if (x >= 0 && x < width && y >= 0 && y < height) {
-        return grid[y][x];
+        return (row(y)[x / WORD_BITS] >> (x % WORD_BITS)) & 1;
     }
     return false;
 }
 
-int Universe::countNeighbors(int x, int y) const {
-    int count = 0;
+// Меньшие доски считаются в одном потоке: запуск пула дороже шага
+static const long long PARALLEL_MIN_WORDS = 1 << 14;
+
+// Плитка активна, если она или одна из восьми соседних (с учётом тора)
+// изменилась в последнем поколении. Возвращает число неактивных плиток.
+long long Universe::findActiveTiles() {
+    long long skipped = 0;
+    for (int ty = 0; ty < tileRows; ++ty) {
+        for (int tx = 0; tx < rowWords; ++tx) {
+            bool active = false;
+            for (int dy = -1; dy <= 1 && !active; ++dy) {
+                int ny = (ty + dy + tileRows) % tileRows;
+                for (int dx = -1; dx <= 1 && !active; ++dx) {
+                    int nx = (tx + dx + rowWords) % rowWords;
+                    active = changedTiles[static_cast<size_t>(ny) * rowWords + nx] != 0;
+                }
+            }
+            size_t index = static_cast<size_t>(ty) * rowWords + tx;
+            activeTiles[index] = active;
+            nextChangedTiles[index] = 0;
+            if (!active) {
+                skipped++;
+            }
+        }
+    }
+    return skipped;
+}
+
+// Считает активные плитки в строках плиток [firstTileRow, endTileRow)
+// в задний буфер, 64 клетки за раз: соседи складываются побитово сумматорами
+template <class Rules>
+void Universe::stepTileRows(int firstTileRow, int endTileRow, Rules rules) {
+    int lastBits = width - (rowWords - 1) * WORD_BITS;
+    Word lastMask = lastBits == WORD_BITS ? ~Word(0) : (Word(1) << lastBits) - 1;
     
-    for (int dx = -1; dx <= 1; ++dx) {
-        for (int dy = -1; dy <= 1; ++dy) {
-            if (dx == 0 && dy == 0) continue;
-            
-            int nx = (x + dx + width) % width;
-            int ny = (y + dy + height) % height;
+    for (int ty = firstTileRow; ty < endTileRow; ++ty) {
+        const unsigned char* active = activeTiles.data() + static_cast<size_t>(ty) * rowWords;
+        unsigned char* changed = nextChangedTiles.data() + static_cast<size_t>(ty) * rowWords;
+        int endRow = std::min(height, (ty + 1) * TILE_ROWS);
+        
+        for (int y = ty * TILE_ROWS; y < endRow; ++y) {
+            const Word* north = row((y + height - 1) % height);
+            const Word* middle = row(y);
+            const Word* south = row((y + 1) % height);
+            Word* out = nextCells.data() + static_cast<size_t>(y) * rowWords;
             
-            if (grid[ny][nx]) {
-                count++;
+            // Крайние слова замыкаются через край тора, серии активных слов
+            // между ними считает векторное ядро
+            int w = 0;
+            while (w < rowWords) {
+                if (!active[w]) {
+                    w++;
+                } else if (w == 0 || w == rowWords - 1) {
+                    lifekernel::Count count = lifekernel::countNeighbors(
+                        lifekernel::westWord(north, w, rowWords, width), north[w],
+                        lifekernel::eastWord(north, w, rowWords, width),
+                        lifekernel::westWord(middle, w, rowWords, width),
+                        lifekernel::eastWord(middle, w, rowWords, width),
+                        lifekernel::westWord(south, w, rowWords, width), south[w],
+                        lifekernel::eastWord(south, w, rowWords, width));
+                    Word next = rules(middle[w], count);
+                    if (w == rowWords - 1) {
+                        next &= lastMask;
+                    }
+                    out[w] = next;
+                    changed[w] |= next != middle[w];
+                    w++;
+                } else {
+                    int end = w + 1;
+                    while (end < rowWords - 1 && active[end]) {
+                        end++;
+                    }
+                    lifekernel::stepWords(north, middle, south, out, changed, w, end, rules);
+                    w = end;
+                }
             }
         }
     }
-    
-    return count;
 }
 
-bool Universe::applyRules(bool currentState, int neighbors) const {
-    if (currentState) {
-        return survivalRules.find(neighbors) != survivalRules.end();
+// Для частых правил цикл собирается с правилом, известным при компиляции
+void Universe::stepTileRows(int firstTileRow, int endTileRow) {
+    using namespace lifekernel;
+    
+    if (birthMask == ConwayRules::BIRTH && survivalMask == ConwayRules::SURVIVAL) {
+        stepTileRows(firstTileRow, endTileRow, ConwayRules());
+    } else if (birthMask == HighLifeRules::BIRTH && survivalMask == HighLifeRules::SURVIVAL) {
+        stepTileRows(firstTileRow, endTileRow, HighLifeRules());
+    } else if (birthMask == SeedsRules::BIRTH && survivalMask == SeedsRules::SURVIVAL) {
+        stepTileRows(firstTileRow, endTileRow, SeedsRules());
     } else {
-        return birthRules.find(neighbors) != birthRules.end();
+        stepTileRows(firstTileRow, endTileRow, MaskRules{birthMask, survivalMask});
     }
 }
 
+// Новое поколение пишется в задний буфер, который затем меняется местами
+// с текущим, так что шаг не выделяет памяти. Неактивные плитки не
+// пересчитываются: в заднем буфере уже лежит их (неизменное) содержимое.
 void Universe::nextGeneration() {
-    std::vector<std::vector<bool>> newGrid = grid;
-    
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            int neighbors = countNeighbors(x, y);
-            newGrid[y][x] = applyRules(grid[y][x], neighbors);
+    if (width > 0 && height > 0) {
+        skippedTiles = findActiveTiles();
+        if (skippedTiles < getTileCount()) {
+            if (pool && static_cast<long long>(height) * rowWords >= PARALLEL_MIN_WORDS) {
+                // Несколько полос на поток, чтобы выровнять нагрузку.
+                // parallel_for возвращается, когда готовы все полосы.
+                size_t bands = static_cast<size_t>(pool->size()) * 4;
+                size_t bandTileRows = (tileRows + bands - 1) / bands;
+                pool->parallel_for(tileRows, bandTileRows, [&](size_t begin, size_t end) {
+                    stepTileRows(static_cast<int>(begin), static_cast<int>(end));
+                });
+            } else {
+                stepTileRows(0, tileRows);
+            }
+            
+            cells.swap(nextCells);
         }
+        changedTiles.swap(nextChangedTiles);
     }
-    
-    grid = newGrid;
     generation++;
 }
 
-void Universe::nextGenerations(int n) {
-    for (int i = 0; i < n; ++i) {
+void Universe::markAllChanged() {
+    std::fill(changedTiles.begin(), changedTiles.end(), 1);
+}
+
+void Universe::setThreads(int threads) {
+    if (threads < 0) {
+        throw std::invalid_argument("Number of threads must be non-negative");
+    }
+    if (threads == 0) {
+        threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+    
+    if (threads == 1) {
+        pool.reset();
+    } else if (getThreads() != threads) {
+        pool = std::make_shared<ThreadPool>(threads);
+    }
+}
+
+void Universe::nextGenerations(long long n) {
+    for (long long i = 0; i < n; ++i) {
         nextGeneration();
     }
 }
 
 void Universe::loadFromFile(const std::string& filename) {
-    Parser parser;
-    GameConfig config = parser.parse(filename);
-    
-    name = config.name;
-    birthRules = config.birthRules;
-    survivalRules = config.survivalRules;
-    
-    width = (config.maxX - config.minX + 1) + 4;
-    height = (config.maxY - config.minY + 1) + 4;
-    int offsetX = -config.minX + 2;
-    int offsetY = -config.minY + 2;
-    
-    grid.clear();
-    grid.resize(height, std::vector<bool>(width, false));
-    
-    for (const auto& coord : config.coordinates) {
-        int x = coord.first + offsetX;
-        int y = coord.second + offsetY;
-        if (x >= 0 && x < width && y >= 0 && y < height) {
-            grid[y][x] = true;
-        }
-    }
+    loadPattern(filename, getThreads(), false, [this](const GameConfig& config, int, int, int w, int h) {
+        name = config.name;
+        birthRules = config.birthRules;
+        survivalRules = config.survivalRules;
+        compileRules();
+        
+        width = w;
+        height = h;
+        allocateGrid();
+    });
 }
 
 void Universe::saveToFile(const std::string& filename) const {
-    std::ofstream file(filename);
-    if (!file.is_open()) {
-        throw std::runtime_error("Cannot create file: " + filename);
+    FileWriter file(filename);
+    if (isRleFile(filename)) {
+        writeRle(file);
+    } else {
+        writeLife(file);
     }
+    file.close();
+}
+
+// Живые клетки берутся из слов ряда по младшему биту, а хвост " y\n"
+// форматируется один раз на ряд и копируется целым блоком
+void Universe::writeLife(FileWriter& file) const {
+    file.write("#Life 1.06\n#N " + name + "\n#R " + getRulesString() + "\n");
     
-    file << "#Life 1.06\n";
-    file << "#N " << name << "\n";
-    file << "#R " << getRulesString() << "\n";
-    
+    char suffix[FileWriter::MAX_LINE / 2];
     for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            if (grid[y][x]) {
-                file << x << " " << y << "\n";
+        suffix[0] = ' ';
+        char* suffixEnd = FileWriter::appendNumber(suffix + 1, y);
+        *suffixEnd++ = '\n';
+        size_t suffixSize = static_cast<size_t>(suffixEnd - suffix);
+        
+        const Word* words = row(y);
+        for (int w = 0; w < rowWords; ++w) {
+            for (Word word = words[w]; word != 0; word &= word - 1) {
+                char* pos = file.reserve(FileWriter::MAX_LINE);
+                pos = FileWriter::appendNumber(pos, w * WORD_BITS + __builtin_ctzl(word));
+                std::memcpy(pos, suffix, suffixSize);
+                file.commit(pos + suffixSize);
             }
         }
     }
 }
 
-std::string Universe::getRulesString() const {
-    std::string result = "B";
-    for (int rule : birthRules) {
-        result += std::to_string(rule);
-    }
-    result += "/S";
-    for (int rule : survivalRules) {
-        result += std::to_string(rule);
+// Серии единиц слова передаются целиком: начало - младший бит, длина -
+// число единиц подряд от него
+void Universe::writeRle(FileWriter& file) const {
+    writeRleHeader(file, width, height, 0, 0);
+    RleWriter rle(file, 0, 0);
+    for (int y = 0; y < height; ++y) {
+        const Word* words = row(y);
+        for (int w = 0; w < rowWords; ++w) {
+            Word word = words[w];
+            while (word != 0) {
+                int start = __builtin_ctzl(word);
+                Word rest = ~(word >> start);
+                int length = rest == 0 ? WORD_BITS : __builtin_ctzl(rest);
+                rle.cells(static_cast<long long>(w) * WORD_BITS + start, y, length);
+                word = start + length < WORD_BITS ? word & (~Word(0) << (start + length)) : 0;
+            }
+        }
     }
-    return result;
+    rle.finish();
+}
+
+std::string Universe::getRulesString() const {
+    return formatRules(birthRules, survivalRules);
 }
 
 void Universe::clear() {
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            grid[y][x] = false;
-        }
-    }
+    cells.reset();
+    markAllChanged();
     generation = 0;
 }
\ No newline at end of file
@@ -1,43 +1,83 @@
 #ifndef UNIVERSE_H
 #define UNIVERSE_H
 
+#include "BitArray.h"
+#include "LifeEngine.h"
+#include "ThreadPool.h"
+#include <memory>
 #include <vector>
 #include <string>
 #include <set>
 
-class Universe {
+class Universe : public LifeEngine {
 private:
     int width;
     int height;
-    std::vector<std::vector<bool>> grid;
+    int rowWords;   // Слов на строку, строки выровнены по слову
+    BitArray cells; // Клетка (x, y) - бит y * rowWords * WORD_BITS + x
+    BitArray nextCells; // Задний буфер того же размера, меняется местами с cells
+    
+    // Доска делится на плитки: одно слово в ширину, TILE_ROWS строк в высоту.
+    // changedTiles[i] - плитка изменилась за последнее поколение или через
+    // setCell. У неизменённой плитки задний буфер совпадает с текущим, поэтому
+    // плитку, вокруг которой ничего не менялось, можно не пересчитывать.
+    static const int TILE_ROWS = 64;
+    int tileRows;
+    std::vector<unsigned char> changedTiles;
+    std::vector<unsigned char> nextChangedTiles;
+    std::vector<unsigned char> activeTiles;
+    long long skippedTiles;
     std::set<int> birthRules;
     std::set<int> survivalRules;
+    unsigned birthMask;    // Правила, собранные в битовые маски (см. lifekernel::ruleMask)
+    unsigned survivalMask;
     std::string name;
-    int generation;
+    long long generation;
+    std::shared_ptr<ThreadPool> pool; // nullptr - шаги в одном потоке
 
-    int countNeighbors(int x, int y) const;
-    bool applyRules(bool currentState, int neighbors) const;
+    void allocateGrid();
+    unsigned long* row(int y) { return cells.data() + static_cast<size_t>(y) * rowWords; }
+    const unsigned long* row(int y) const { return cells.data() + static_cast<size_t>(y) * rowWords; }
+    void markAllChanged();
+    long long findActiveTiles();
+    void compileRules();
+    void stepTileRows(int firstTileRow, int endTileRow);
+    template <class Rules>
+    void stepTileRows(int firstTileRow, int endTileRow, Rules rules);
+    void writeLife(FileWriter& file) const;
+    void writeRle(FileWriter& file) const;
 
 public:
     Universe(int w, int h, const std::string& universeName = "Universe");
-    Universe(const std::string& filename);
+    Universe(const std::string& filename, int threads = 1);
+    
+    void setRules(const std::set<int>& birth, const std::set<int>& survival) override;
+    void setCell(int x, int y, bool state) override;
+    bool getCell(int x, int y) const override;
+    void nextGeneration() override;
+    void nextGenerations(long long n) override;
+    
+    // Число потоков для шагов: 1 - последовательно, 0 - по числу ядер.
+    // Строки доски делятся на полосы, которые считает постоянный пул потоков;
+    // результат не зависит от числа потоков.
+    void setThreads(int threads) override;
+    int getThreads() const { return pool ? static_cast<int>(pool->size()) : 1; }
     
-    void setRules(const std::set<int>& birth, const std::set<int>& survival);
-    void setCell(int x, int y, bool state);
-    bool getCell(int x, int y) const;
-    void nextGeneration();
-    void nextGenerations(int n);
+    // Число плиток и сколько из них не пересчитывалось в последнем поколении
+    int getTileCount() const { return tileRows * rowWords; }
+    long long getSkippedTiles() const { return skippedTiles; }
     
+    // Файл разбирается тем же числом потоков, что и шаги (setThreads)
     void loadFromFile(const std::string& filename);
-    void saveToFile(const std::string& filename) const;
+    void saveToFile(const std::string& filename) const override;
     
-    int getWidth() const { return width; }
-    int getHeight() const { return height; }
-    int getGeneration() const { return generation; }
-    const std::string& getName() const { return name; }
-    std::string getRulesString() const;
+    int getWidth() const override { return width; }
+    int getHeight() const override { return height; }
+    long long getGeneration() const override { return generation; }
+    const std::string& getName() const override { return name; }
+    std::string getRulesString() const override;
     
-    void clear();
+    void clear() override;
 };
 
 #endif
\ No newline at end of file
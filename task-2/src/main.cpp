@@ -7,12 +7,17 @@ void printUsage() {
     std::cout << "  gameoflife [input_file]                    - Interactive mode with optional input file\n";
     std::cout << "  gameoflife --input input_file --iterations n --output output_file  - Offline mode\n";
     std::cout << "  gameoflife -i n -o output_file input_file  - Alternative offline syntax\n";
+    std::cout << "Options:\n";
+    std::cout << "  --threads n                                - Threads for loading the input file and computing generations (0 - all cores)\n";
+    std::cout << "  --engine name                              - Engine for input files: universe (default), hashlife or sparse\n";
 }
 
 int main(int argc, char* argv[]) {
     std::string inputFile;
     std::string outputFile;
     int iterations = 0;
+    int threads = 1;
+    std::string engine = "universe";
     bool offlineMode = false;
     
     for (int i = 1; i < argc; ++i) {
@@ -28,6 +33,14 @@ int main(int argc, char* argv[]) {
                 outputFile = argv[++i];
                 offlineMode = true;
             }
+        } else if (arg == "--threads") {
+            if (i + 1 < argc) {
+                threads = std::stoi(argv[++i]);
+            }
+        } else if (arg == "--engine") {
+            if (i + 1 < argc) {
+                engine = argv[++i];
+            }
         } else if (arg == "--input") {
             if (i + 1 < argc) {
                 inputFile = argv[++i];
@@ -46,13 +59,14 @@ int main(int argc, char* argv[]) {
             }
             
             GameOfLife game;
-            game.runOffline(inputFile, outputFile, iterations);
+            game.runOffline(inputFile, outputFile, iterations, threads, engine);
         } else {
             if (inputFile.empty()) {
                 GameOfLife game;
+                game.getEngine().setThreads(threads);
                 game.run();
             } else {
-                GameOfLife game(inputFile);
+                GameOfLife game(inputFile, engine, threads);
                 game.run();
             }
         }
@@ -108,6 +108,41 @@ TEST_F(TestGameOfLife, RunOfflineModeSuccess) {
     std::remove(outputFile.c_str());
 }
 
+TEST_F(TestGameOfLife, RunOfflineModeWithHashLife) {
+    GameOfLife game;
+    
+    const std::string inputFile = "test_offline_hashlife.life";
+    std::ofstream inFile(inputFile);
+    inFile << "#Life 1.06\n";
+    inFile << "#N HashLife Offline\n";
+    inFile << "#R B3/S23\n";
+    inFile << "0 0\n";
+    inFile << "1 0\n";
+    inFile << "2 0\n";
+    inFile.close();
+    
+    const std::string outputFile = "test_offline_hashlife_output.life";
+    game.runOffline(inputFile, outputFile, 1000001, 1, "hashlife");
+    
+    std::string output = getOutput();
+    EXPECT_TRUE(output.find("Completed") != std::string::npos) << "Output was: " << output;
+    
+    // Мигалка с нечётным числом шагов становится вертикальной
+    GameOfLife result(outputFile, "hashlife");
+    EXPECT_EQ(result.getEngine().getGeneration(), 0);
+    EXPECT_THROW(result.getUniverse(), std::logic_error);
+    EXPECT_TRUE(result.getEngine().getCell(1, -1));
+    EXPECT_TRUE(result.getEngine().getCell(1, 0));
+    EXPECT_TRUE(result.getEngine().getCell(1, 1));
+    
+    game.runOffline(inputFile, outputFile, 1, 1, "unknown");
+    output = getOutput();
+    EXPECT_TRUE(output.find("Error") != std::string::npos) << "Output was: " << output;
+    
+    std::remove(inputFile.c_str());
+    std::remove(outputFile.c_str());
+}
+
 TEST_F(TestGameOfLife, RunOfflineModeInvalidInputFile) {
     GameOfLife game;
     
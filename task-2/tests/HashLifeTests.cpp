@@ -0,0 +1,309 @@
+#include "../src/HashLife.h"
+#include "../src/Universe.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <set>
+
+class HashLifeTest : public ::testing::Test {
+protected:
+    void createGlider(LifeEngine& engine, int x, int y) {
+        engine.setCell(x + 1, y, true);
+        engine.setCell(x + 2, y + 1, true);
+        engine.setCell(x, y + 2, true);
+        engine.setCell(x + 1, y + 2, true);
+        engine.setCell(x + 2, y + 2, true);
+    }
+    
+    // R-пентамино: хаотично развивается больше тысячи поколений
+    void createRPentomino(LifeEngine& engine, int x, int y) {
+        engine.setCell(x + 1, y, true);
+        engine.setCell(x + 2, y, true);
+        engine.setCell(x, y + 1, true);
+        engine.setCell(x + 1, y + 1, true);
+        engine.setCell(x + 1, y + 2, true);
+    }
+    
+    void expectSameCells(const LifeEngine& a, const LifeEngine& b, int width, int height) {
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                ASSERT_EQ(a.getCell(x, y), b.getCell(x, y)) << x << "," << y;
+            }
+        }
+    }
+};
+
+TEST_F(HashLifeTest, ConstructorInitializesCorrectly) {
+    HashLife life(20, 10, "Hash Universe");
+    EXPECT_EQ(life.getWidth(), 20);
+    EXPECT_EQ(life.getHeight(), 10);
+    EXPECT_EQ(life.getName(), "Hash Universe");
+    EXPECT_EQ(life.getGeneration(), 0);
+    EXPECT_EQ(life.getPopulation(), 0);
+    EXPECT_EQ(life.getRulesString(), "B3/S23");
+}
+
+TEST_F(HashLifeTest, SetAndGetCellAnywhere) {
+    HashLife life(10, 10);
+    life.setCell(3, 4, true);
+    life.setCell(-1000, 2000000, true);
+    life.setCell(2000000000, -2000000000, true);
+    
+    EXPECT_TRUE(life.getCell(3, 4));
+    EXPECT_TRUE(life.getCell(-1000, 2000000));
+    EXPECT_TRUE(life.getCell(2000000000, -2000000000));
+    EXPECT_FALSE(life.getCell(4, 3));
+    EXPECT_EQ(life.getPopulation(), 3);
+    
+    life.setCell(3, 4, false);
+    EXPECT_FALSE(life.getCell(3, 4));
+    EXPECT_EQ(life.getPopulation(), 2);
+}
+
+TEST_F(HashLifeTest, MatchesUniverseAwayFromEdges) {
+    // Тор достаточно велик, чтобы за 300 поколений ничего не обернулось
+    Universe universe(400, 400);
+    HashLife life(400, 400);
+    createRPentomino(universe, 200, 200);
+    createRPentomino(life, 200, 200);
+    
+    universe.nextGenerations(3);
+    life.nextGenerations(3);
+    expectSameCells(universe, life, 400, 400);
+    
+    for (int i = 0; i < 7; ++i) {
+        universe.nextGeneration();
+        life.nextGeneration();
+    }
+    expectSameCells(universe, life, 400, 400);
+    
+    universe.nextGenerations(290);
+    life.nextGenerations(290);
+    EXPECT_EQ(life.getGeneration(), 300);
+    expectSameCells(universe, life, 400, 400);
+}
+
+TEST_F(HashLifeTest, CustomRulesMatchUniverse) {
+    Universe universe(300, 300);
+    HashLife life(300, 300);
+    universe.setRules({3, 6}, {2, 3});
+    life.setRules({3, 6}, {2, 3});
+    
+    unsigned seed = 42;
+    for (int y = 140; y < 160; ++y) {
+        for (int x = 140; x < 160; ++x) {
+            seed = seed * 1103515245 + 12345;
+            bool alive = (seed >> 16) % 2 == 0;
+            universe.setCell(x, y, alive);
+            life.setCell(x, y, alive);
+        }
+    }
+    
+    universe.nextGenerations(100);
+    life.nextGenerations(100);
+    expectSameCells(universe, life, 300, 300);
+}
+
+TEST_F(HashLifeTest, GliderSkipsBillionGenerations) {
+    HashLife life(10, 10);
+    createGlider(life, 0, 0);
+    
+    // Глайдер сдвигается на (1, 1) каждые 4 поколения
+    life.nextGenerations(1000000000);
+    EXPECT_EQ(life.getGeneration(), 1000000000);
+    EXPECT_EQ(life.getPopulation(), 5);
+    
+    const int shift = 250000000;
+    EXPECT_TRUE(life.getCell(shift + 1, shift));
+    EXPECT_TRUE(life.getCell(shift + 2, shift + 1));
+    EXPECT_TRUE(life.getCell(shift, shift + 2));
+    EXPECT_TRUE(life.getCell(shift + 1, shift + 2));
+    EXPECT_TRUE(life.getCell(shift + 2, shift + 2));
+}
+
+TEST_F(HashLifeTest, RPentominoStabilizes) {
+    HashLife stepped(10, 10);
+    HashLife jumped(10, 10);
+    createRPentomino(stepped, 0, 0);
+    createRPentomino(jumped, 0, 0);
+    
+    for (int i = 0; i < 1103; ++i) {
+        stepped.nextGeneration();
+    }
+    jumped.nextGenerations(1103);
+    
+    // Известный итог: 116 клеток к поколению 1103, включая 6 глайдеров
+    EXPECT_EQ(stepped.getPopulation(), 116);
+    EXPECT_EQ(jumped.getPopulation(), 116);
+    
+    jumped.nextGenerations(1000000);
+    EXPECT_EQ(jumped.getPopulation(), 116);
+}
+
+TEST_F(HashLifeTest, OscillatorAfterHugeEvenStep) {
+    HashLife life(10, 10);
+    life.setCell(4, 5, true);
+    life.setCell(5, 5, true);
+    life.setCell(6, 5, true);
+    
+    life.nextGenerations(1LL << 40);
+    EXPECT_EQ(life.getGeneration(), 1LL << 40);
+    EXPECT_TRUE(life.getCell(4, 5));
+    EXPECT_TRUE(life.getCell(5, 5));
+    EXPECT_TRUE(life.getCell(6, 5));
+    EXPECT_EQ(life.getPopulation(), 3);
+    
+    life.nextGeneration();
+    EXPECT_TRUE(life.getCell(5, 4));
+    EXPECT_TRUE(life.getCell(5, 6));
+    EXPECT_FALSE(life.getCell(4, 5));
+}
+
+TEST_F(HashLifeTest, RejectsBirthOnZeroNeighbors) {
+    HashLife life(10, 10);
+    EXPECT_THROW(life.setRules({0, 3}, {2, 3}), std::invalid_argument);
+    EXPECT_EQ(life.getRulesString(), "B3/S23");
+}
+
+TEST_F(HashLifeTest, FileRoundTripWithUniverse) {
+    const std::string inputFile = "test_hashlife_input.life";
+    const std::string outputFile = "test_hashlife_output.life";
+    
+    std::ofstream file(inputFile);
+    file << "#Life 1.06\n";
+    file << "#N HashLife Test\n";
+    file << "#R B3/S23\n";
+    file << "1 0\n";
+    file << "2 1\n";
+    file << "0 2\n";
+    file << "1 2\n";
+    file << "2 2\n";
+    file.close();
+    
+    // Клетки остаются на своих координатах, а видимая область совпадает
+    // с полем Universe, загруженной из того же файла
+    HashLife life(inputFile);
+    Universe universe(inputFile);
+    EXPECT_EQ(life.getName(), "HashLife Test");
+    EXPECT_EQ(life.getViewX(), -2);
+    EXPECT_EQ(life.getViewY(), -2);
+    EXPECT_EQ(life.getWidth(), universe.getWidth());
+    EXPECT_EQ(life.getHeight(), universe.getHeight());
+    EXPECT_TRUE(life.getCell(1, 0));
+    for (int y = 0; y < universe.getHeight(); ++y) {
+        for (int x = 0; x < universe.getWidth(); ++x) {
+            ASSERT_EQ(universe.getCell(x, y), life.getCell(life.getViewX() + x, life.getViewY() + y)) << x << "," << y;
+        }
+    }
+    
+    life.nextGenerations(8);
+    ASSERT_NO_THROW(life.saveToFile(outputFile));
+    
+    HashLife reloaded(outputFile);
+    EXPECT_EQ(reloaded.getPopulation(), 5);
+    EXPECT_EQ(reloaded.getRulesString(), "B3/S23");
+    
+    std::remove(inputFile.c_str());
+    std::remove(outputFile.c_str());
+}
+
+TEST_F(HashLifeTest, EngineFactory) {
+    std::unique_ptr<LifeEngine> engine = LifeEngine::create("hashlife", 16, 8, "Factory");
+    EXPECT_NE(dynamic_cast<HashLife*>(engine.get()), nullptr);
+    EXPECT_EQ(engine->getWidth(), 16);
+    
+    engine = LifeEngine::create("universe", 16, 8, "Factory");
+    EXPECT_NE(dynamic_cast<Universe*>(engine.get()), nullptr);
+    
+    EXPECT_THROW(LifeEngine::create("unknown", 16, 8, "Factory"), std::invalid_argument);
+}
+
+TEST_F(HashLifeTest, FarCellDoesNotGrowView) {
+    const std::string inputFile = "test_hashlife_far.life";
+    
+    std::ofstream file(inputFile);
+    file << "#Life 1.06\n";
+    file << "0 0\n";
+    file << "1 0\n";
+    file << "2 0\n";
+    file << "1000000000 1000000000\n";
+    file.close();
+    
+    HashLife life(inputFile);
+    EXPECT_EQ(life.getViewX(), -2);
+    EXPECT_EQ(life.getViewY(), -2);
+    EXPECT_EQ(life.getWidth(), 256);
+    EXPECT_EQ(life.getHeight(), 256);
+    EXPECT_EQ(life.getPopulation(), 4);
+    EXPECT_TRUE(life.getCell(0, 0));
+    EXPECT_TRUE(life.getCell(1000000000, 1000000000));
+    
+    life.nextGeneration();
+    EXPECT_TRUE(life.getCell(1, -1));
+    EXPECT_TRUE(life.getCell(1, 1));
+    EXPECT_EQ(life.getPopulation(), 3);
+    
+    std::remove(inputFile.c_str());
+}
+
+TEST_F(HashLifeTest, EmptyPatternLoadsInEveryEngine) {
+    const std::string inputFile = "test_empty_pattern.life";
+    std::ofstream(inputFile) << "#Life 1.06\n#N Empty\n";
+    
+    for (const std::string name : {"universe", "hashlife", "sparse"}) {
+        std::unique_ptr<LifeEngine> engine = LifeEngine::create(name, inputFile);
+        EXPECT_EQ(engine->getName(), "Empty") << name;
+        EXPECT_EQ(engine->getViewX(), 0) << name;
+        EXPECT_EQ(engine->getViewY(), 0) << name;
+        EXPECT_EQ(engine->getWidth(), 5) << name;
+        EXPECT_EQ(engine->getHeight(), 5) << name;
+        
+        engine->nextGenerations(3);
+        for (int y = 0; y < engine->getHeight(); ++y) {
+            for (int x = 0; x < engine->getWidth(); ++x) {
+                EXPECT_FALSE(engine->getCell(x, y)) << name << " " << x << "," << y;
+            }
+        }
+    }
+    
+    std::remove(inputFile.c_str());
+}
+
+TEST_F(HashLifeTest, DenseFileBuildsOnlyReachableNodes) {
+    const std::string inputFile = "test_hashlife_soup.life";
+    
+    std::ofstream file(inputFile);
+    file << "#Life 1.06\n";
+    unsigned seed = 2024;
+    long long cells = 0;
+    for (int y = 0; y < 300; ++y) {
+        for (int x = 0; x < 300; ++x) {
+            seed = seed * 1103515245 + 12345;
+            if ((seed >> 16) % 3 == 0) {
+                file << x + 7 << " " << y - 11 << "\n";
+                ++cells;
+            }
+        }
+    }
+    file.close();
+    
+    // Узлов не больше, чем блоков 4x4 и крупнее, плюс 16 блоков 2x2;
+    // setCell на каждую клетку дал бы порядка cells * 9 узлов
+    HashLife life(inputFile);
+    Universe universe(inputFile);
+    EXPECT_EQ(life.getPopulation(), cells);
+    EXPECT_LT(life.getNodeCount(), 10000u);
+    
+    for (int generation = 0; generation < 2; ++generation) {
+        for (int y = 0; y < universe.getHeight(); ++y) {
+            for (int x = 0; x < universe.getWidth(); ++x) {
+                ASSERT_EQ(universe.getCell(x, y), life.getCell(life.getViewX() + x, life.getViewY() + y))
+                    << x << "," << y;
+            }
+        }
+        universe.nextGeneration();
+        life.nextGeneration();
+    }
+    
+    std::remove(inputFile.c_str());
+}
@@ -0,0 +1,368 @@
+#include "../src/Parser.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Запоминает, что и в каком порядке передал Parser::load
+class RecordingSink : public CellSink {
+public:
+    GameConfig header;
+    std::vector<std::pair<int, int>> cells;
+    int begins = 0;
+    bool cellBeforeBegin = false;
+    
+    void begin(const GameConfig& config) override {
+        header = config;
+        begins++;
+    }
+    
+    void cell(int x, int y) override {
+        cellBeforeBegin = cellBeforeBegin || begins == 0;
+        cells.emplace_back(x, y);
+    }
+};
+
+class ParserTest : public ::testing::Test {
+protected:
+    const std::string testFile = "parser_test.life";
+    
+    void TearDown() override {
+        std::remove(testFile.c_str());
+    }
+    
+    // Больше CHUNK_SIZE байт, последняя строка без перевода строки
+    static std::string largeContent() {
+        std::ostringstream content;
+        content << "#Life 1.06\n#N Large\n#R B36/S23\n";
+        for (int i = 0; i < 200000; ++i) {
+            content << (i % 1000) - 500 << " " << i / 1000 << "\n";
+        }
+        content << "-123456 654321";
+        return content.str();
+    }
+    
+    static void expectSameConfig(const GameConfig& a, const GameConfig& b) {
+        EXPECT_EQ(a.name, b.name);
+        EXPECT_EQ(a.rulesString, b.rulesString);
+        EXPECT_EQ(a.birthRules, b.birthRules);
+        EXPECT_EQ(a.survivalRules, b.survivalRules);
+        EXPECT_EQ(a.coordinates, b.coordinates);
+        EXPECT_EQ(a.minX, b.minX);
+        EXPECT_EQ(a.maxX, b.maxX);
+        EXPECT_EQ(a.minY, b.minY);
+        EXPECT_EQ(a.maxY, b.maxY);
+    }
+    
+    // load передаёт те же клетки, что parse кладёт в coordinates, а
+    // заголовок и границы - до первой клетки
+    static void expectLoaded(const RecordingSink& sink, const GameConfig& loaded, GameConfig expected) {
+        EXPECT_EQ(sink.begins, 1);
+        EXPECT_FALSE(sink.cellBeforeBegin);
+        EXPECT_EQ(sink.cells, expected.coordinates);
+        
+        expected.coordinates.clear();
+        expectSameConfig(sink.header, expected);
+        expectSameConfig(loaded, expected);
+    }
+};
+
+TEST_F(ParserTest, ParsesHeaderAndCoordinates) {
+    Parser parser;
+    GameConfig config = parser.parseFromString("#Life 1.06\n#N Test Pattern\n#R B36/S23\n1 2\n-3 4\n  5\t-6\n");
+    
+    EXPECT_EQ(config.name, "Test Pattern");
+    EXPECT_EQ(config.rulesString, "B36/S23");
+    EXPECT_EQ(config.birthRules, (std::set<int>{3, 6}));
+    EXPECT_EQ(config.survivalRules, (std::set<int>{2, 3}));
+    
+    std::vector<std::pair<int, int>> expected = {{1, 2}, {-3, 4}, {5, -6}};
+    EXPECT_EQ(config.coordinates, expected);
+    EXPECT_EQ(config.minX, -3);
+    EXPECT_EQ(config.maxX, 5);
+    EXPECT_EQ(config.minY, -6);
+    EXPECT_EQ(config.maxY, 4);
+}
+
+TEST_F(ParserTest, AcceptsCrLfCommentsAndBlankLines) {
+    Parser parser;
+    GameConfig config = parser.parseFromString("#Life 1.06\r\n#N Windows\r\n# comment\r\n\r\n\n+7 8\r\n9 10");
+    
+    EXPECT_EQ(config.name, "Windows");
+    std::vector<std::pair<int, int>> expected = {{7, 8}, {9, 10}};
+    EXPECT_EQ(config.coordinates, expected);
+}
+
+TEST_F(ParserTest, RejectsInvalidInput) {
+    Parser parser;
+    EXPECT_THROW(parser.parseFromString("1 2\n"), ParseException);
+    EXPECT_THROW(parser.parseFromString(""), ParseException);
+    EXPECT_THROW(parser.parseFromString("#Life 1.06\na b\n"), ParseException);
+    EXPECT_THROW(parser.parseFromString("#Life 1.06\n1\n"), ParseException);
+    EXPECT_THROW(parser.parseFromString("#Life 1.06\n1, 2\n"), ParseException);
+    EXPECT_THROW(parser.parseFromString("#Life 1.06\n99999999999 1\n"), ParseException);
+    EXPECT_THROW(parser.parseFromString("#Life 1.06\n#R 23/3\n"), ParseException);
+    EXPECT_THROW(parser.parse("no_such_file.life"), ParseException);
+}
+
+TEST_F(ParserTest, MappedFileMatchesString) {
+    std::string content = largeContent();
+    ASSERT_GT(content.size(), Parser::CHUNK_SIZE);
+    std::ofstream(testFile) << content;
+    
+    Parser parser;
+    GameConfig fromFile = parser.parse(testFile);
+    GameConfig fromString = parser.parseFromString(content);
+    expectSameConfig(fromFile, fromString);
+    EXPECT_EQ(fromFile.coordinates.size(), 200001u);
+    EXPECT_EQ(fromFile.minX, -123456);
+    EXPECT_EQ(fromFile.maxY, 654321);
+}
+
+TEST_F(ParserTest, EmptyFileHasNoHeader) {
+    std::ofstream(testFile).close();
+    Parser parser;
+    EXPECT_THROW(parser.parse(testFile), ParseException);
+}
+
+TEST_F(ParserTest, ReadsPipeInChunks) {
+    // Канал нельзя отобразить в память: строки читаются кусками
+    const std::string pipe = "parser_test.fifo";
+    std::remove(pipe.c_str());
+    ASSERT_EQ(::mkfifo(pipe.c_str(), 0600), 0);
+    
+    std::string content = largeContent();
+    std::thread writer([&]() {
+        std::ofstream(pipe) << content;
+    });
+    
+    Parser parser;
+    GameConfig fromPipe = parser.parse(pipe);
+    writer.join();
+    std::remove(pipe.c_str());
+    
+    expectSameConfig(fromPipe, parser.parseFromString(content));
+}
+
+// Больше PARALLEL_MIN_BYTES, со строками заголовка и комментариями в середине
+static std::string parallelContent(const std::string& tail) {
+    std::ostringstream content;
+    content << "#Life 1.06\n#N First\n";
+    for (int i = 0; i < 600000; ++i) {
+        if (i == 300000) {
+            content << "#N Second\n# comment\n#R B36/S23\n";
+        }
+        content << (i * 7919LL) % 20011 - 10000 << " " << (i * 104729LL) % 30011 - 15000 << "\n";
+    }
+    content << tail;
+    return content.str();
+}
+
+TEST_F(ParserTest, ParallelParseMatchesSequential) {
+    std::string content = parallelContent("123456 -654321\n");
+    ASSERT_GT(content.size(), Parser::PARALLEL_MIN_BYTES);
+    
+    Parser sequential;
+    Parser parallel;
+    parallel.setThreads(4);
+    EXPECT_EQ(parallel.getThreads(), 4);
+    
+    GameConfig expected = sequential.parseFromString(content);
+    EXPECT_EQ(expected.name, "Second");
+    EXPECT_EQ(expected.rulesString, "B36/S23");
+    expectSameConfig(parallel.parseFromString(content), expected);
+    
+    std::ofstream(testFile) << content;
+    expectSameConfig(parallel.parse(testFile), expected);
+    
+    parallel.setThreads(1);
+    EXPECT_EQ(parallel.getThreads(), 1);
+    EXPECT_THROW(parallel.setThreads(-1), std::invalid_argument);
+}
+
+TEST_F(ParserTest, ParallelParseBoundsAwayFromOrigin) {
+    std::ostringstream content;
+    content << "#Life 1.06\n";
+    for (int i = 0; i < 600000; ++i) {
+        content << 1000 + i % 997 << " " << 2000 + i % 1009 << "\n";
+    }
+    
+    Parser parallel;
+    parallel.setThreads(4);
+    GameConfig config = parallel.parseFromString(content.str());
+    EXPECT_EQ(config.minX, 1000);
+    EXPECT_EQ(config.maxX, 1996);
+    EXPECT_EQ(config.minY, 2000);
+    EXPECT_EQ(config.maxY, 3008);
+}
+
+TEST_F(ParserTest, ParallelParseReportsErrors) {
+    Parser parallel;
+    parallel.setThreads(4);
+    
+    EXPECT_THROW(parallel.parseFromString(parallelContent("1 x\n")), ParseException);
+    
+    std::string noHeader = parallelContent("");
+    noHeader[1] = 'X';
+    EXPECT_THROW(parallel.parseFromString(noHeader), ParseException);
+}
+
+
+TEST_F(ParserTest, LoadStreamsCellsAfterHeader) {
+    std::string content = largeContent();
+    std::ofstream(testFile) << content;
+    
+    Parser parser;
+    RecordingSink sink;
+    GameConfig loaded = parser.load(testFile, sink);
+    expectLoaded(sink, loaded, parser.parseFromString(content));
+}
+
+TEST_F(ParserTest, ParallelLoadKeepsFileOrder) {
+    std::string content = parallelContent("123456 -654321\n");
+    std::ofstream(testFile) << content;
+    
+    Parser parser;
+    parser.setThreads(4);
+    RecordingSink sink;
+    GameConfig loaded = parser.load(testFile, sink);
+    expectLoaded(sink, loaded, parser.parseFromString(content));
+    EXPECT_EQ(loaded.name, "Second");
+}
+
+TEST_F(ParserTest, LoadFromPipe) {
+    const std::string pipe = "parser_test.fifo";
+    std::remove(pipe.c_str());
+    ASSERT_EQ(::mkfifo(pipe.c_str(), 0600), 0);
+    
+    std::string content = largeContent();
+    std::thread writer([&]() {
+        std::ofstream(pipe) << content;
+    });
+    
+    Parser parser;
+    RecordingSink sink;
+    GameConfig loaded = parser.load(pipe, sink);
+    writer.join();
+    std::remove(pipe.c_str());
+    
+    expectLoaded(sink, loaded, parser.parseFromString(content));
+}
+
+TEST_F(ParserTest, LoadReportsErrorsBeforeCells) {
+    std::ofstream(testFile) << "#Life 1.06\n1 2\n3 x\n";
+    
+    Parser parser;
+    RecordingSink sink;
+    EXPECT_THROW(parser.load(testFile, sink), ParseException);
+    EXPECT_EQ(sink.begins, 0);
+    EXPECT_TRUE(sink.cells.empty());
+    EXPECT_THROW(parser.load("no_such_file.life", sink), ParseException);
+}
+
+TEST_F(ParserTest, ParsesRle) {
+    Parser parser;
+    GameConfig config = parser.parseFromString(
+        "#N Glider\r\n#C A comment\r\n#O Someone\r\nx = 3, y = 3, rule = B3/S23\r\nbo$2bo$3o!\r\n");
+    
+    EXPECT_EQ(config.format, "RLE");
+    EXPECT_EQ(config.name, "Glider");
+    EXPECT_EQ(config.rulesString, "B3/S23");
+    std::vector<std::pair<int, int>> expected = {{1, 0}, {2, 1}, {0, 2}, {1, 2}, {2, 2}};
+    EXPECT_EQ(config.coordinates, expected);
+    EXPECT_EQ(config.minX, 0);
+    EXPECT_EQ(config.maxX, 2);
+    EXPECT_EQ(config.minY, 0);
+    EXPECT_EQ(config.maxY, 2);
+}
+
+TEST_F(ParserTest, ParsesRleRulesOffsetAndLongRuns) {
+    Parser parser;
+    // Старая запись правил S/B, угол узора и серии, разорванные переводом строки
+    GameConfig config = parser.parseFromString("#R -5 7\nx = 14, y = 4, rule = 23/36\n1\n2o2$b\n.o");
+    EXPECT_EQ(config.birthRules, (std::set<int>{3, 6}));
+    EXPECT_EQ(config.survivalRules, (std::set<int>{2, 3}));
+    ASSERT_EQ(config.coordinates.size(), 13u);
+    EXPECT_EQ(config.coordinates.front(), std::make_pair(-5, 7));
+    EXPECT_EQ(config.coordinates[11], std::make_pair(6, 7));
+    EXPECT_EQ(config.coordinates.back(), std::make_pair(-3, 9));
+    EXPECT_EQ(config.minX, -5);
+    EXPECT_EQ(config.maxX, 6);
+    EXPECT_EQ(config.maxY, 9);
+    
+    config = parser.parseFromString("#r b36s23\nx=1,y=1\no!");
+    EXPECT_EQ(config.rulesString, "B36S23");
+    EXPECT_EQ(config.birthRules, (std::set<int>{3, 6}));
+    
+    // Расширенная запись Golly: суффикс поля после ':' отбрасывается
+    config = parser.parseFromString("x = 3, y = 1, rule = B36/S23:T100,100\n3o!");
+    EXPECT_EQ(config.rulesString, "B36/S23");
+    EXPECT_EQ(config.birthRules, (std::set<int>{3, 6}));
+    EXPECT_EQ(config.survivalRules, (std::set<int>{2, 3}));
+    EXPECT_EQ(config.coordinates.size(), 3u);
+}
+
+TEST_F(ParserTest, RejectsInvalidRle) {
+    Parser parser;
+    EXPECT_THROW(parser.parseFromString("x = 3\no!"), ParseException);
+    EXPECT_THROW(parser.parseFromString("x = 3, y = a\no!"), ParseException);
+    EXPECT_THROW(parser.parseFromString("x = 3, y = 3\n2q!"), ParseException);
+    EXPECT_THROW(parser.parseFromString("x = 3, y = 3\n99999999999o!"), ParseException);
+    EXPECT_THROW(parser.parseFromString("#R 1\nx = 3, y = 3\no!"), ParseException);
+}
+
+TEST_F(ParserTest, LargeRleFileMatchesString) {
+    // Больше PARALLEL_MIN_BYTES: RLE и с потоками разбирается последовательно
+    std::ostringstream rle;
+    rle << "#N Big\nx = 4000, y = 3000, rule = B3/S23\n";
+    unsigned seed = 5;
+    for (int y = 0; y < 3000; ++y) {
+        for (int x = 0; x < 4000; x += 2) {
+            seed = seed * 1103515245 + 12345;
+            rle << ((seed >> 16) % 3 == 0 ? "ob" : "2b");
+        }
+        rle << "$\n";
+    }
+    rle << "!";
+    std::string content = rle.str();
+    ASSERT_GT(content.size(), Parser::PARALLEL_MIN_BYTES);
+    std::ofstream(testFile) << content;
+    
+    Parser parser;
+    parser.setThreads(4);
+    GameConfig expected = Parser().parseFromString(content);
+    EXPECT_EQ(expected.name, "Big");
+    EXPECT_GT(expected.coordinates.size(), 1000000u);
+    expectSameConfig(parser.parseFromString(content), expected);
+    expectSameConfig(parser.parse(testFile), expected);
+    
+    RecordingSink sink;
+    GameConfig loaded = parser.load(testFile, sink);
+    expectLoaded(sink, loaded, expected);
+}
+
+TEST_F(ParserTest, ReadsRleFromPipe) {
+    const std::string pipe = "parser_test.fifo";
+    std::remove(pipe.c_str());
+    ASSERT_EQ(::mkfifo(pipe.c_str(), 0600), 0);
+    
+    // Длинный блок комментариев: формат ясен только со второго куска
+    std::string content(Parser::CHUNK_SIZE + 100, ' ');
+    content.replace(0, 3, "#C ");
+    content += "\nx = 3, y = 3\nbo$2bo$3o!\n";
+    std::thread writer([&]() {
+        std::ofstream(pipe) << content;
+    });
+    
+    Parser parser;
+    GameConfig fromPipe = parser.parse(pipe);
+    writer.join();
+    std::remove(pipe.c_str());
+    
+    expectSameConfig(fromPipe, parser.parseFromString(content));
+    EXPECT_EQ(fromPipe.coordinates.size(), 5u);
+}
@@ -0,0 +1,222 @@
+#include "../src/SparseUniverse.h"
+#include "../src/Universe.h"
+#include "../src/Parser.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+
+class SparseUniverseTest : public ::testing::Test {
+protected:
+    void createGlider(LifeEngine& engine, int x, int y) {
+        engine.setCell(x + 1, y, true);
+        engine.setCell(x + 2, y + 1, true);
+        engine.setCell(x, y + 2, true);
+        engine.setCell(x + 1, y + 2, true);
+        engine.setCell(x + 2, y + 2, true);
+    }
+    
+    void expectSameCells(const LifeEngine& a, const LifeEngine& b, int width, int height) {
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                ASSERT_EQ(a.getCell(x, y), b.getCell(x, y)) << x << "," << y;
+            }
+        }
+    }
+};
+
+TEST_F(SparseUniverseTest, SetAndGetCellAcrossTiles) {
+    SparseUniverse universe(10, 10);
+    EXPECT_EQ(universe.getTileCount(), 0u);
+    
+    universe.setCell(0, 0, true);
+    universe.setCell(-1, -1, true);
+    universe.setCell(63, 64, true);
+    universe.setCell(5000000, -3000000, true);
+    
+    EXPECT_TRUE(universe.getCell(0, 0));
+    EXPECT_TRUE(universe.getCell(-1, -1));
+    EXPECT_TRUE(universe.getCell(63, 64));
+    EXPECT_TRUE(universe.getCell(5000000, -3000000));
+    EXPECT_FALSE(universe.getCell(64, 63));
+    EXPECT_EQ(universe.getTileCount(), 4u);
+    EXPECT_EQ(universe.getPopulation(), 4);
+    
+    // Опустевшая плитка освобождается
+    universe.setCell(-1, -1, false);
+    EXPECT_FALSE(universe.getCell(-1, -1));
+    EXPECT_EQ(universe.getTileCount(), 3u);
+    
+    universe.setCell(-100, -100, false);
+    EXPECT_EQ(universe.getTileCount(), 3u);
+}
+
+TEST_F(SparseUniverseTest, MatchesUniverseAcrossTileBorders) {
+    Universe dense(256, 256);
+    SparseUniverse sparse(256, 256);
+    dense.setRules({3, 6}, {2, 3});
+    sparse.setRules({3, 6}, {2, 3});
+    
+    // Случайное пятно поверх стыка четырёх плиток
+    unsigned seed = 99;
+    for (int y = 110; y < 146; ++y) {
+        for (int x = 110; x < 146; ++x) {
+            seed = seed * 1103515245 + 12345;
+            bool alive = (seed >> 16) % 3 == 0;
+            dense.setCell(x, y, alive);
+            sparse.setCell(x, y, alive);
+        }
+    }
+    
+    for (int step = 0; step < 60; ++step) {
+        dense.nextGeneration();
+        sparse.nextGeneration();
+    }
+    EXPECT_EQ(sparse.getGeneration(), 60);
+    expectSameCells(dense, sparse, 256, 256);
+}
+
+TEST_F(SparseUniverseTest, GliderFarFromOriginUsesFewTiles) {
+    SparseUniverse universe(10, 10);
+    createGlider(universe, 3000000, -2000000);
+    
+    universe.nextGenerations(400);
+    EXPECT_EQ(universe.getPopulation(), 5);
+    EXPECT_LE(universe.getTileCount(), 4u);
+    
+    // Глайдер сдвигается на (1, 1) каждые 4 поколения
+    int x = 3000000 + 100;
+    int y = -2000000 + 100;
+    EXPECT_TRUE(universe.getCell(x + 1, y));
+    EXPECT_TRUE(universe.getCell(x + 2, y + 1));
+    EXPECT_TRUE(universe.getCell(x, y + 2));
+    EXPECT_TRUE(universe.getCell(x + 1, y + 2));
+    EXPECT_TRUE(universe.getCell(x + 2, y + 2));
+}
+
+TEST_F(SparseUniverseTest, DeadPatternFreesTiles) {
+    SparseUniverse universe(10, 10);
+    universe.setCell(63, 63, true);
+    universe.setCell(64, 64, true);
+    
+    universe.nextGeneration();
+    EXPECT_EQ(universe.getPopulation(), 0);
+    EXPECT_EQ(universe.getTileCount(), 0u);
+    EXPECT_THROW(universe.setRules({0}, {}), std::invalid_argument);
+}
+
+TEST_F(SparseUniverseTest, SettledTilesAreNotRecomputed) {
+    Universe dense(256, 256);
+    SparseUniverse sparse(256, 256);
+    
+    // Блоки в трёх плитках (один на стыке) и мигалка внутри четвёртой
+    for (LifeEngine* engine : {static_cast<LifeEngine*>(&dense), static_cast<LifeEngine*>(&sparse)}) {
+        for (int base : {10, 63, 140}) {
+            engine->setCell(base, base, true);
+            engine->setCell(base + 1, base, true);
+            engine->setCell(base, base + 1, true);
+            engine->setCell(base + 1, base + 1, true);
+        }
+        engine->setCell(200, 20, true);
+        engine->setCell(201, 20, true);
+        engine->setCell(202, 20, true);
+    }
+    
+    sparse.nextGenerations(3);
+    dense.nextGenerations(3);
+    EXPECT_EQ(sparse.getChangedTileCount(), 1u);
+    expectSameCells(dense, sparse, 256, 256);
+    
+    // Клетка рядом с устоявшимся блоком снова будит его плитку
+    dense.setCell(12, 10, true);
+    sparse.setCell(12, 10, true);
+    sparse.nextGenerations(5);
+    dense.nextGenerations(5);
+    expectSameCells(dense, sparse, 256, 256);
+    
+    // Смена правил пересчитывает все плитки: блоки с S1 вымирают
+    dense.setRules({3}, {1});
+    sparse.setRules({3}, {1});
+    sparse.nextGeneration();
+    dense.nextGeneration();
+    expectSameCells(dense, sparse, 256, 256);
+    EXPECT_FALSE(sparse.getCell(140, 140));
+}
+
+TEST_F(SparseUniverseTest, FileRoundTrip) {
+    const std::string inputFile = "test_sparse_input.life";
+    const std::string outputFile = "test_sparse_output.life";
+    
+    std::ofstream file(inputFile);
+    file << "#Life 1.06\n";
+    file << "#N Sparse Test\n";
+    file << "#R B3/S23\n";
+    file << "1000000 1000000\n";
+    file << "1000001 1000000\n";
+    file << "1000002 1000000\n";
+    file << "-1000000 -1000000\n";
+    file << "-999999 -1000000\n";
+    file << "-1000000 -999999\n";
+    file << "-999999 -999999\n";
+    file.close();
+    
+    SparseUniverse universe(inputFile);
+    EXPECT_EQ(universe.getName(), "Sparse Test");
+    EXPECT_EQ(universe.getPopulation(), 7);
+    EXPECT_LE(universe.getTileCount(), 2u);
+    
+    // Клетки на исходных координатах, область видимости не растягивается
+    // на весь узор
+    EXPECT_TRUE(universe.getCell(1000002, 1000000));
+    EXPECT_TRUE(universe.getCell(-1000000, -1000000));
+    EXPECT_EQ(universe.getViewX(), -1000002);
+    EXPECT_EQ(universe.getViewY(), -1000002);
+    EXPECT_EQ(universe.getWidth(), 256);
+    EXPECT_EQ(universe.getHeight(), 256);
+    
+    universe.nextGeneration();
+    ASSERT_NO_THROW(universe.saveToFile(outputFile));
+    
+    SparseUniverse reloaded(outputFile);
+    EXPECT_EQ(reloaded.getPopulation(), 7);
+    EXPECT_EQ(reloaded.getRulesString(), "B3/S23");
+    
+    std::unique_ptr<LifeEngine> engine = LifeEngine::create("sparse", inputFile);
+    EXPECT_NE(dynamic_cast<SparseUniverse*>(engine.get()), nullptr);
+    
+    std::remove(inputFile.c_str());
+    std::remove(outputFile.c_str());
+}
+
+TEST_F(SparseUniverseTest, RleRoundTripKeepsNegativeCoordinates) {
+    const std::string rleFile = "test_sparse_output.rle";
+    const std::string lifeFile = "test_sparse_output.life";
+    
+    SparseUniverse universe(10, 10, "Far Gliders");
+    universe.setRules({3, 6}, {2, 3});
+    createGlider(universe, -200, -70);
+    createGlider(universe, 500, 3);
+    for (int x = 0; x < 150; ++x) {
+        universe.setCell(x, 1000, true);
+    }
+    universe.saveToFile(rleFile);
+    universe.saveToFile(lifeFile);
+    
+    Parser parser;
+    GameConfig rle = parser.parse(rleFile);
+    GameConfig life = parser.parse(lifeFile);
+    EXPECT_EQ(rle.format, "RLE");
+    EXPECT_EQ(rle.name, "Far Gliders");
+    EXPECT_EQ(rle.birthRules, life.birthRules);
+    EXPECT_EQ(rle.coordinates, life.coordinates);
+    EXPECT_EQ(rle.minX, -200);
+    EXPECT_EQ(rle.maxY, 1000);
+    
+    std::ifstream file(rleFile);
+    std::string line;
+    while (std::getline(file, line)) {
+        EXPECT_LE(line.size(), 70u);
+    }
+    
+    std::remove(rleFile.c_str());
+    std::remove(lifeFile.c_str());
+}
@@ -1,7 +1,52 @@
 #include "../src/Universe.h"
+#include "../src/LifeKernel.h"
+#include "../src/Parser.h"
 #include <gtest/gtest.h>
+#include <cstdlib>
 #include <fstream>
+#include <new>
 #include <set>
+#include <sstream>
+#include <vector>
+
+// Счётчик выделений памяти, чтобы проверять, что шаги не трогают кучу.
+// Операторы не встраиваются: иначе GCC видит malloc() и free() по разные
+// стороны new/delete и предупреждает о несовпадении.
+static size_t g_allocations = 0;
+
+__attribute__((noinline)) void* operator new(size_t size) {
+    ++g_allocations;
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+__attribute__((noinline)) void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+// Выровненные версии (через них выделяет память BitArray)
+__attribute__((noinline)) void* operator new(size_t size, std::align_val_t align) {
+    ++g_allocations;
+    size_t alignment = static_cast<size_t>(align);
+    if (void* ptr = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void* ptr, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+__attribute__((noinline)) void operator delete(void* ptr, size_t, std::align_val_t) noexcept {
+    std::free(ptr);
+}
 
 class UniverseTest : public ::testing::Test {
 protected:
@@ -188,6 +233,79 @@ TEST_F(UniverseTest, FileOperations) {
     std::remove(testFile.c_str());
 }
 
+// Файл больше буфера FileWriter и побайтно совпадает с построчной записью
+// через getCell
+TEST(UniverseSaveTest, WritesLiveCellsInRowOrder) {
+    const std::string testFile = "test_universe_save.life";
+    const int width = 64 * 5 + 7;
+    const int height = 3000;
+    Universe universe(width, height, "Saved");
+    universe.setRules({3, 6}, {2, 3});
+    
+    std::ostringstream expected;
+    expected << "#Life 1.06\n#N Saved\n#R B36/S23\n";
+    unsigned seed = 7;
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            seed = seed * 1103515245 + 12345;
+            bool alive = (seed >> 16) % 3 == 0 || x == 0 || x == width - 1;
+            universe.setCell(x, y, alive);
+            if (alive) {
+                expected << x << " " << y << "\n";
+            }
+        }
+    }
+    ASSERT_GT(expected.str().size(), 2 * (1u << 20));
+    
+    universe.saveToFile(testFile);
+    std::ifstream file(testFile, std::ios::binary);
+    std::ostringstream written;
+    written << file.rdbuf();
+    EXPECT_TRUE(written.str() == expected.str());
+    
+    std::remove(testFile.c_str());
+    EXPECT_THROW(universe.saveToFile("no_such_dir/out.life"), std::runtime_error);
+}
+
+// Обход по сериям слов: серии через границы слов, слово из одних единиц,
+// последняя клетка ряда
+TEST(UniverseSaveTest, RleRoundTripAndSize) {
+    const std::string rleFile = "test_universe_save.rle";
+    const std::string lifeFile = "test_universe_save.life";
+    const int width = 64 * 4 + 9;
+    const int height = 300;
+    Universe universe(width, height, "Runs");
+    
+    unsigned seed = 11;
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            seed = seed * 1103515245 + 12345;
+            bool alive = (seed >> 16) % 4 != 0 || (y == 7 && x >= 60 && x < 200) || x == width - 1;
+            universe.setCell(x, y, alive && y != 5);
+        }
+    }
+    universe.setCell(0, 0, true);
+    
+    universe.saveToFile(rleFile);
+    universe.saveToFile(lifeFile);
+    Universe loaded(rleFile);
+    EXPECT_EQ(loaded.getName(), "Runs");
+    EXPECT_EQ(loaded.getWidth(), width + 4);
+    EXPECT_EQ(loaded.getHeight(), height + 4);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            ASSERT_EQ(loaded.getCell(x + 2, y + 2), universe.getCell(x, y)) << x << "," << y;
+        }
+    }
+    
+    std::ifstream rle(rleFile, std::ios::binary | std::ios::ate);
+    std::ifstream life(lifeFile, std::ios::binary | std::ios::ate);
+    EXPECT_LT(rle.tellg() * 4, life.tellg());
+    
+    std::remove(rleFile.c_str());
+    std::remove(lifeFile.c_str());
+}
+
 TEST_F(UniverseTest, ToroidalWrapping) {
     universe->clear();
     
@@ -239,6 +357,33 @@ TEST_F(UniverseTest, LoadFromFileWithParser) {
     std::remove(testFile.c_str());
 }
 
+TEST_F(UniverseTest, LoadFromFileWithThreads) {
+    const std::string testFile = "test_parser_threads.life";
+    
+    // Файл больше Parser::PARALLEL_MIN_BYTES, чтобы разбор шёл через пул
+    std::ofstream file(testFile);
+    file << "#Life 1.06\n";
+    unsigned seed = 4242;
+    for (size_t written = 0; written < 2 * Parser::PARALLEL_MIN_BYTES; written += 8) {
+        seed = seed * 1103515245 + 12345;
+        file << (seed >> 8) % 900 + 100 << ' ' << (seed >> 20) % 900 + 100 << '\n';
+    }
+    file.close();
+    
+    Universe serial(testFile);
+    Universe parallel(testFile, 4);
+    EXPECT_EQ(parallel.getThreads(), 4);
+    ASSERT_EQ(parallel.getWidth(), serial.getWidth());
+    ASSERT_EQ(parallel.getHeight(), serial.getHeight());
+    for (int y = 0; y < serial.getHeight(); ++y) {
+        for (int x = 0; x < serial.getWidth(); ++x) {
+            ASSERT_EQ(parallel.getCell(x, y), serial.getCell(x, y)) << x << "," << y;
+        }
+    }
+    
+    std::remove(testFile.c_str());
+}
+
 TEST_F(UniverseTest, LoadFileWithCustomRules) {
     const std::string testFile = "test_custom_rules.life";
     
@@ -257,4 +402,267 @@ TEST_F(UniverseTest, LoadFileWithCustomRules) {
     });
     
     std::remove(testFile.c_str());
-}
\ No newline at end of file
+}
+
+// Эталон: прямой подсчёт соседей на торе
+static std::vector<std::vector<bool>> referenceStep(const std::vector<std::vector<bool>>& grid,
+                                                    const std::set<int>& birth,
+                                                    const std::set<int>& survival) {
+    int height = static_cast<int>(grid.size());
+    int width = static_cast<int>(grid[0].size());
+    std::vector<std::vector<bool>> next(height, std::vector<bool>(width, false));
+    
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            int neighbors = 0;
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    if (dx == 0 && dy == 0) continue;
+                    if (grid[(y + dy + height) % height][(x + dx + width) % width]) {
+                        neighbors++;
+                    }
+                }
+            }
+            next[y][x] = grid[y][x] ? survival.count(neighbors) > 0 : birth.count(neighbors) > 0;
+        }
+    }
+    return next;
+}
+
+TEST(UniverseBitKernelTest, MatchesReferenceOnTorus) {
+    const int sizes[][2] = {{1, 1}, {2, 3}, {10, 10}, {63, 5}, {64, 64}, {65, 7}, {130, 33}};
+    const std::set<int> rules[][2] = {{{3}, {2, 3}}, {{3, 6}, {2, 3}}, {{2}, {}}, {{0, 1, 8}, {0, 4, 8}}};
+    
+    unsigned seed = 12345;
+    for (const auto& size : sizes) {
+        for (const auto& rule : rules) {
+            int width = size[0];
+            int height = size[1];
+            Universe universe(width, height);
+            universe.setRules(rule[0], rule[1]);
+            
+            std::vector<std::vector<bool>> grid(height, std::vector<bool>(width, false));
+            for (int y = 0; y < height; ++y) {
+                for (int x = 0; x < width; ++x) {
+                    seed = seed * 1103515245 + 12345;
+                    grid[y][x] = (seed >> 16) % 3 == 0;
+                    universe.setCell(x, y, grid[y][x]);
+                }
+            }
+            
+            for (int step = 0; step < 5; ++step) {
+                grid = referenceStep(grid, rule[0], rule[1]);
+                universe.nextGeneration();
+                for (int y = 0; y < height; ++y) {
+                    for (int x = 0; x < width; ++x) {
+                        ASSERT_EQ(universe.getCell(x, y), grid[y][x])
+                            << width << "x" << height << " " << universe.getRulesString()
+                            << " step " << step << " cell " << x << "," << y;
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Правила, известные при компиляции, дают то же, что и маски
+template <class Rules>
+static void expectSameAsMasks(Rules rules) {
+    lifekernel::MaskRules masks{Rules::BIRTH, Rules::SURVIVAL};
+    lifekernel::Word seed = 0x9e3779b97f4a7c15UL;
+    for (int i = 0; i < 1000; ++i) {
+        lifekernel::Word words[5];
+        for (lifekernel::Word& word : words) {
+            seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+            word = seed;
+        }
+        // Счётчики больше 8 не встречаются
+        lifekernel::Count count{words[0], words[1], words[2], words[3] & ~words[0] & ~words[1] & ~words[2]};
+        ASSERT_EQ(rules(words[4], count), masks(words[4], count)) << "B" << Rules::BIRTH << " S" << Rules::SURVIVAL;
+    }
+}
+
+TEST(UniverseBitKernelTest, FixedRulesMatchMasks) {
+    expectSameAsMasks(lifekernel::ConwayRules());
+    expectSameAsMasks(lifekernel::HighLifeRules());
+    expectSameAsMasks(lifekernel::SeedsRules());
+}
+
+TEST(UniverseBitKernelTest, GliderCrossesWordBoundaryOnLargeTorus) {
+    Universe universe(4096, 4096);
+    universe.setCell(61, 0, true);
+    universe.setCell(62, 1, true);
+    universe.setCell(60, 2, true);
+    universe.setCell(61, 2, true);
+    universe.setCell(62, 2, true);
+    
+    // За 4 поколения глайдер сдвигается на (1, 1)
+    universe.nextGenerations(8);
+    EXPECT_TRUE(universe.getCell(63, 2));
+    EXPECT_TRUE(universe.getCell(64, 3));
+    EXPECT_TRUE(universe.getCell(62, 4));
+    EXPECT_TRUE(universe.getCell(63, 4));
+    EXPECT_TRUE(universe.getCell(64, 4));
+    EXPECT_FALSE(universe.getCell(61, 0));
+}
+
+TEST(UniverseBitKernelTest, GenerationsDoNotAllocate) {
+    Universe universe(200, 100);
+    universe.setCell(1, 0, true);
+    universe.setCell(2, 1, true);
+    universe.setCell(0, 2, true);
+    universe.setCell(1, 2, true);
+    universe.setCell(2, 2, true);
+    
+    universe.nextGeneration();
+    size_t before = g_allocations;
+    universe.nextGenerations(10000);
+    EXPECT_EQ(g_allocations, before);
+    EXPECT_EQ(universe.getGeneration(), 10001);
+}
+
+TEST(UniverseBitKernelTest, ParallelStepsMatchSerial) {
+    // Доска достаточно велика, чтобы шаги шли через пул
+    Universe serial(1061, 1000);
+    Universe parallel(1061, 1000);
+    parallel.setThreads(4);
+    EXPECT_EQ(parallel.getThreads(), 4);
+    
+    unsigned seed = 777;
+    for (int y = 0; y < 1000; ++y) {
+        for (int x = 0; x < 1061; ++x) {
+            seed = seed * 1103515245 + 12345;
+            bool alive = (seed >> 16) % 4 == 0;
+            serial.setCell(x, y, alive);
+            parallel.setCell(x, y, alive);
+        }
+    }
+    
+    serial.nextGenerations(20);
+    parallel.nextGenerations(20);
+    for (int y = 0; y < 1000; ++y) {
+        for (int x = 0; x < 1061; ++x) {
+            ASSERT_EQ(parallel.getCell(x, y), serial.getCell(x, y)) << x << "," << y;
+        }
+    }
+    
+    parallel.setThreads(1);
+    EXPECT_EQ(parallel.getThreads(), 1);
+    EXPECT_THROW(parallel.setThreads(-1), std::invalid_argument);
+}
+
+TEST(UniverseBitKernelTest, StableRegionsAreSkipped) {
+    // 10 x 10 плиток по 64 x 64 клетки
+    Universe universe(640, 640);
+    EXPECT_EQ(universe.getTileCount(), 100);
+    
+    // Блок (натюрморт) и мигалка в разных плитках
+    universe.setCell(100, 100, true);
+    universe.setCell(101, 100, true);
+    universe.setCell(100, 101, true);
+    universe.setCell(101, 101, true);
+    universe.setCell(400, 400, true);
+    universe.setCell(401, 400, true);
+    universe.setCell(402, 400, true);
+    
+    universe.nextGeneration();
+    EXPECT_EQ(universe.getSkippedTiles(), 0);
+    
+    // Дальше меняется только плитка мигалки: считаются она и 8 соседей
+    for (int i = 0; i < 10; ++i) {
+        universe.nextGeneration();
+        EXPECT_EQ(universe.getSkippedTiles(), 91);
+    }
+    EXPECT_TRUE(universe.getCell(100, 100));
+    EXPECT_TRUE(universe.getCell(101, 101));
+    EXPECT_TRUE(universe.getCell(401, 399));
+    EXPECT_TRUE(universe.getCell(401, 401));
+    
+    // Клетка в спокойной области снова делает её активной
+    universe.setCell(600, 600, true);
+    universe.nextGeneration();
+    EXPECT_FALSE(universe.getCell(600, 600));
+    EXPECT_EQ(universe.getSkippedTiles(), 91 - 9);
+}
+
+TEST(UniverseBitKernelTest, SkippingMatchesReference) {
+    const int width = 200;
+    const int height = 150;
+    Universe universe(width, height);
+    std::vector<std::vector<bool>> grid(height, std::vector<bool>(width, false));
+    
+    // Редкий суп в углу: на большей части доски ничего не происходит
+    unsigned seed = 2024;
+    for (int y = 0; y < 40; ++y) {
+        for (int x = 0; x < 40; ++x) {
+            seed = seed * 1103515245 + 12345;
+            bool alive = (seed >> 16) % 3 == 0;
+            grid[y][x] = alive;
+            universe.setCell(x, y, alive);
+        }
+    }
+    
+    const std::set<int> birth{3};
+    const std::set<int> survival{2, 3};
+    for (int step = 0; step < 80; ++step) {
+        if (step == 40) {
+            grid[120][170] = grid[120][171] = grid[120][172] = true;
+            universe.setCell(170, 120, true);
+            universe.setCell(171, 120, true);
+            universe.setCell(172, 120, true);
+        }
+        grid = referenceStep(grid, birth, survival);
+        universe.nextGeneration();
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                ASSERT_EQ(universe.getCell(x, y), grid[y][x]) << "step " << step << " cell " << x << "," << y;
+            }
+        }
+    }
+}
+
+TEST(UniverseBitKernelTest, SimdKernelsMatchReference) {
+    // Ширины, при которых серии слов не делятся нацело на 2 и 4
+    const int sizes[][2] = {{64 * 7 + 13, 20}, {64 * 12, 9}, {64 * 3, 5}};
+    const std::set<int> rules[][2] = {{{3}, {2, 3}}, {{3, 6}, {2, 3}}, {{0, 1, 8}, {0, 4, 8}}};
+    const lifekernel::Simd best = lifekernel::getSimd();
+    
+    for (lifekernel::Simd simd : {lifekernel::Simd::NONE, lifekernel::Simd::SSE2, lifekernel::Simd::AVX2}) {
+        if (!lifekernel::setSimd(simd)) {
+            continue;
+        }
+        
+        unsigned seed = 99;
+        for (const auto& size : sizes) {
+            for (const auto& rule : rules) {
+                int width = size[0];
+                int height = size[1];
+                Universe universe(width, height);
+                universe.setRules(rule[0], rule[1]);
+                
+                std::vector<std::vector<bool>> grid(height, std::vector<bool>(width, false));
+                for (int y = 0; y < height; ++y) {
+                    for (int x = 0; x < width; ++x) {
+                        seed = seed * 1103515245 + 12345;
+                        grid[y][x] = (seed >> 16) % 3 == 0;
+                        universe.setCell(x, y, grid[y][x]);
+                    }
+                }
+                
+                for (int step = 0; step < 4; ++step) {
+                    grid = referenceStep(grid, rule[0], rule[1]);
+                    universe.nextGeneration();
+                    for (int y = 0; y < height; ++y) {
+                        for (int x = 0; x < width; ++x) {
+                            ASSERT_EQ(universe.getCell(x, y), grid[y][x])
+                                << "kernel " << static_cast<int>(simd) << " " << width << "x" << height
+                                << " " << universe.getRulesString() << " step " << step;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    
+    lifekernel::setSimd(best);
+}